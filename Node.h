@@ -1,6 +1,14 @@
 #pragma once
 #include <string>
 #include <fstream>
+#include <filesystem> // пути к файлам таблиц
+
+struct TableStats;  // статистика таблицы для планировщика (planner.h)
+struct ChunkBlooms; // фильтры Блума по файлам таблицы (bloom.h)
+struct TableIndexes; // упорядоченные индексы колонок (ordered_index.h)
+struct ChangeFeed;   // журнал вставок и удалений (changefeed.h)
+struct MemTable;     // строки таблицы в памяти (memtable.h)
+struct ChunkFormats; // формат каждого файла таблицы (chunk.h)
 
 // Структура для колонок таблицы
 struct ListNode {
@@ -13,6 +21,22 @@ struct Node {
     std::string table;
     Node* next;
     ListNode* column; // Указатель на список колонок таблицы
+
+    // Пути вычисляются один раз при разборе схемы
+    std::filesystem::path dir;      // директория таблицы (с учётом tablespace)
+    std::filesystem::path lockFile; // <table>_lock.txt
+    std::filesystem::path pkFile;   // <table>_pk_sequence.txt
+    std::filesystem::path header;   // TableJS.csv - шаблон с названиями колонок
+    std::string compression;        // "lz4", "zstd" или пусто - сжатие заполненных файлов
+    int partitionColumn = -1;       // "partition_by": номер колонки-ключа, -1 - без разбиения
+    int partitions = 1;             // число партиций (поддиректории p0, p1, ...)
+
+    TableStats* stats = nullptr;    // количество строк, различные значения, min/max
+    ChunkBlooms* blooms = nullptr;  // быстрый отказ по значению без чтения файла
+    TableIndexes* indexes = nullptr; // индексы из "indexes" в схеме, nullptr - индексов нет
+    ChangeFeed* feed = nullptr;     // <table>_changes.log для подписчиков
+    MemTable* mem = nullptr;        // "in_memory": true - таблица в памяти, файлы только снимки
+    ChunkFormats* formats = nullptr; // сжат ли файл N, без повторных обращений к диску
 };
 
 // Структура для описания схемы и таблиц
@@ -20,4 +44,5 @@ struct TableJson {
     std::string Name;      // Название схемы
     Node* Tablehead;       // Указатель на список таблиц
     int TableSize;         // Ограничение по количеству строк (tuples_limit)
+    std::filesystem::path Root; // Корень данных (data_root), по умолчанию текущая директория
 };
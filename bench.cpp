@@ -0,0 +1,288 @@
+// Бенчмарк СУБД: генерирует схему и данные, прогоняет стандартные нагрузки
+// и печатает пропускную способность и задержки (p50/p99) в формате JSON.
+//
+// Сборка: make bench
+// Запуск: ./bench --rows 5000 --width 16 --cardinality 100 --tuples-limit 1000 --out bench_output.txt
+#include "parcer.h"
+#include "select.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Clock = chrono::steady_clock;
+
+const char* const kBenchMark = ".db_bench"; // метка каталога, созданного бенчмарком
+
+// Параметры генератора и нагрузок
+struct BenchConfig {
+    fs::path root = fs::temp_directory_path(); // в нём создаётся каталог db_bench для данных бенчмарка
+    int rows = 2000;        // строк в основной таблице
+    int joinRows = 50;      // строк во второй таблице (для join)
+    int columns = 3;        // колонок в таблицах
+    int width = 16;         // длина значения в символах
+    int cardinality = 100;  // различных значений в колонке
+    int tuplesLimit = 1000; // tuples_limit схемы
+    int deletes = 100;      // точечных удалений
+    int selects = 20;       // выборок с фильтром
+    int joins = 5;          // соединений двух таблиц
+    int threads = 4;        // потоков смешанной нагрузки
+    int mixedOps = 200;     // операций на поток
+    int inMemory = 0;       // 1 - таблица A хранится в памяти ("in_memory": true)
+    int partitions = 0;     // >0 - таблицы A и B разбиты по c1 на столько партиций
+    string out;             // файл для результата (иначе stdout)
+};
+
+// Поток, который всё отбрасывает
+struct NullBuffer : streambuf {
+    int overflow(int c) override { return c; }
+};
+
+// Результат одной нагрузки
+struct Workload {
+    string name;
+    vector<double> latencies; // микросекунды
+    double seconds = 0;
+    int errors = 0;
+};
+
+// Значение фиксированной длины из ограниченного множества
+string makeValue(int column, int id, const BenchConfig& cfg) {
+    string value = "c" + to_string(column) + "v" + to_string(id % cfg.cardinality);
+    if ((int)value.size() < cfg.width) {
+        value.append(cfg.width - value.size(), 'x');
+    }
+    return value;
+}
+
+string makeInsert(const string& table, int id, const BenchConfig& cfg) {
+    string command = "INSERT INTO " + table + " VALUES (";
+    for (int c = 1; c <= cfg.columns; c++) {
+        command += "'" + makeValue(c, id, cfg) + "'";
+        command += c < cfg.columns ? ", " : ")";
+    }
+    return command;
+}
+
+void writeSchema(const BenchConfig& cfg) {
+    json columns = json::array();
+    for (int c = 1; c <= cfg.columns; c++) {
+        columns.push_back("c" + to_string(c));
+    }
+    json schema;
+    schema["name"] = "BenchSchema";
+    schema["tuples_limit"] = cfg.tuplesLimit;
+    schema["data_root"] = cfg.root.string();
+    schema["structure"]["A"] = columns;
+    if (cfg.inMemory) {
+        schema["structure"]["A"] = {{"columns", columns}, {"in_memory", true}};
+    }
+    schema["structure"]["B"] = columns;
+    if (cfg.partitions > 0) {
+        for (const string& table : vector<string>{"A", "B"}) {
+            if (!cfg.inMemory || table != "A") {
+                schema["structure"][table] = {{"columns", columns}, {"partition_by", "c1"}, {"partitions", cfg.partitions}};
+            }
+        }
+    }
+
+    ofstream file(cfg.root / "schema.json");
+    file << schema.dump(2);
+}
+
+// Выполнение одной операции с замером времени; отказ движка и исключения считаются ошибками
+void timed(Workload& w, const function<bool()>& op) {
+    auto start = Clock::now();
+    try {
+        if (!op()) {
+            w.errors++;
+        }
+    } catch (const exception&) {
+        w.errors++;
+    }
+    w.latencies.push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+}
+
+void run(Workload& w, int count, const function<bool(int)>& op) {
+    auto start = Clock::now();
+    for (int i = 0; i < count; i++) {
+        timed(w, [&] { return op(i); });
+    }
+    w.seconds = chrono::duration<double>(Clock::now() - start).count();
+}
+
+double percentile(vector<double> values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    // Метод ближайшего ранга: наименьшее значение, не меньше которого доля p выборки
+    sort(values.begin(), values.end());
+    size_t rank = (size_t)ceil(p * values.size());
+    return values[max<size_t>(rank, 1) - 1];
+}
+
+json report(const Workload& w) {
+    json r;
+    r["name"] = w.name;
+    r["ops"] = w.latencies.size();
+    r["errors"] = w.errors;
+    r["seconds"] = w.seconds;
+    r["ops_per_sec"] = w.seconds > 0 ? w.latencies.size() / w.seconds : 0;
+    r["p50_us"] = percentile(w.latencies, 0.50);
+    r["p99_us"] = percentile(w.latencies, 0.99);
+    return r;
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& cfg) {
+    map<string, int*> intArgs = {
+        {"--rows", &cfg.rows}, {"--join-rows", &cfg.joinRows}, {"--columns", &cfg.columns},
+        {"--width", &cfg.width}, {"--cardinality", &cfg.cardinality}, {"--tuples-limit", &cfg.tuplesLimit},
+        {"--deletes", &cfg.deletes}, {"--selects", &cfg.selects}, {"--joins", &cfg.joins},
+        {"--threads", &cfg.threads}, {"--mixed-ops", &cfg.mixedOps}, {"--in-memory", &cfg.inMemory},
+        {"--partitions", &cfg.partitions},
+    };
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i];
+        if (intArgs.count(key)) {
+            *intArgs[key] = stoi(argv[i + 1]);
+        } else if (key == "--root") {
+            cfg.root = argv[i + 1];
+        } else if (key == "--out") {
+            cfg.out = argv[i + 1];
+        } else {
+            cerr << "Неизвестный параметр: " << key << "\n";
+            return false;
+        }
+    }
+    if (argc % 2 == 0) {
+        cerr << "Параметр без значения: " << argv[argc - 1] << "\n";
+        return false;
+    }
+    if (cfg.columns < 1 || cfg.cardinality < 1 || cfg.tuplesLimit < 1) {
+        cerr << "columns, cardinality и tuples-limit должны быть больше нуля.\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) {
+        return 1;
+    }
+
+    if (!cfg.out.empty()) {
+        cfg.out = fs::absolute(cfg.out).string(); // дальше меняется текущая директория
+    }
+    // Удаляется только свой каталог: db_bench без метки создан не бенчмарком
+    cfg.root /= "db_bench";
+    if (fs::exists(cfg.root) && !fs::exists(cfg.root / kBenchMark)) {
+        cerr << "Каталог " << cfg.root.string() << " создан не бенчмарком, укажите другой --root.\n";
+        return 1;
+    }
+    DellDirectory(cfg.root);
+    fs::create_directories(cfg.root);
+    ofstream(cfg.root / kBenchMark).close();
+    writeSchema(cfg);
+    fs::current_path(cfg.root); // parser читает schema.json из текущей директории
+
+    // Диагностика движка не должна влиять на замеры
+    NullBuffer devNull;
+    streambuf* coutBuf = cout.rdbuf(&devNull);
+    streambuf* cerrBuf = cerr.rdbuf(&devNull);
+
+    TableJson json_table;
+    parser(json_table);
+
+    vector<Workload> results;
+
+    Workload bulk{"bulk_insert"};
+    run(bulk, cfg.rows, [&](int i) { return insert(makeInsert("A", i, cfg), json_table); });
+    results.push_back(bulk);
+
+    for (int i = 0; i < cfg.joinRows; i++) {
+        insert(makeInsert("B", i, cfg), json_table);
+    }
+
+    Workload filtered{"filtered_select"};
+    run(filtered, cfg.selects, [&](int i) {
+        return select("SELECT A.c1 B.c1 FROM A B WHERE A.c1 = B.c1 AND A.c2 = '" + makeValue(2, i, cfg) + "'", json_table);
+    });
+    results.push_back(filtered);
+
+    Workload join{"join"};
+    run(join, cfg.joins, [&](int) { return select("SELECT A.c1 B.c1 FROM A B", json_table); });
+    results.push_back(join);
+
+    // Удаления по первичному ключу: каждое убирает одну строку, A не пустеет перед смешанной нагрузкой
+    Workload pointDelete{"point_delete"};
+    run(pointDelete, min(cfg.deletes, cfg.rows / 2), [&](int i) {
+        return delet("DELETE FROM A WHERE A.A_pk = '" + to_string(1 + 2 * i) + "'", json_table);
+    });
+    results.push_back(pointDelete);
+
+    // Смешанная нагрузка: потоки чередуют вставки, выборки и удаления. Движок не
+    // потокобезопасен (файл блокировки и последовательность ключей читаются без
+    // взаимного исключения), поэтому команды выполняются по очереди под engineLock;
+    // задержка включает ожидание своей очереди.
+    Workload mixed{"mixed_serialized"};
+    mutex engineLock;
+    vector<Workload> perThread(cfg.threads);
+    auto mixedStart = Clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < cfg.threads; t++) {
+        workers.emplace_back([&, t] {
+            mt19937 rng(t);
+            for (int i = 0; i < cfg.mixedOps; i++) {
+                int id = rng() % cfg.cardinality;
+                int kind = rng() % 10;
+                timed(perThread[t], [&] {
+                    lock_guard<mutex> guard(engineLock);
+                    if (kind < 5) {
+                        return insert(makeInsert("A", id, cfg), json_table);
+                    } else if (kind < 9) {
+                        return select("SELECT A.c1 B.c1 FROM A B WHERE A.c1 = B.c1 AND A.c1 = '" + makeValue(1, id, cfg) + "'", json_table);
+                    }
+                    return delet("DELETE FROM A WHERE A.c1 = '" + makeValue(1, id, cfg) + "'", json_table);
+                });
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    mixed.seconds = chrono::duration<double>(Clock::now() - mixedStart).count();
+    for (const auto& w : perThread) {
+        mixed.latencies.insert(mixed.latencies.end(), w.latencies.begin(), w.latencies.end());
+        mixed.errors += w.errors;
+    }
+    results.push_back(mixed);
+    shutdownMemTables(json_table);
+
+    cout.rdbuf(coutBuf);
+    cerr.rdbuf(cerrBuf);
+
+    json output;
+    output["config"] = {
+        {"rows", cfg.rows}, {"join_rows", cfg.joinRows}, {"columns", cfg.columns}, {"width", cfg.width},
+        {"cardinality", cfg.cardinality}, {"tuples_limit", cfg.tuplesLimit}, {"threads", cfg.threads},
+        {"in_memory", cfg.inMemory != 0}, {"partitions", cfg.partitions},
+    };
+    output["workloads"] = json::array();
+    for (const auto& w : results) {
+        output["workloads"].push_back(report(w));
+    }
+
+    if (cfg.out.empty()) {
+        cout << output.dump(2) << endl;
+    } else {
+        ofstream file(cfg.out);
+        file << output.dump(2) << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "bloom.h"
+#include "chunk.h"
+#include "insert.h"
+#include "hash.h"
+
+namespace {
+    const int kHashes = 7;
+    const char kMagic[4] = {'B', 'L', 'O', 'M'};
+    const uint32_t kVersion = 2; // 2: FNV-1a; 1 (без заголовка) - std::hash, зависел от сборки
+
+    // Две хеш-функции для схемы h1 + i * h2; FNV-1a одинаков в любой сборке, поэтому N.bloom переносим
+    pair<uint64_t, uint64_t> hashes(const string& value) {
+        uint64_t h1 = stableHash(value);
+        uint64_t h2 = h1 * 0x9E3779B97F4A7C15ULL;
+        h2 ^= h2 >> 31;
+        return {h1, h2 | 1};
+    }
+
+    fs::path bloomPath(const Node* table, int csvNumber) {
+        return chunkPath(table, csvNumber).replace_extension(".bloom");
+    }
+
+    vector<BloomFilter> build(rapidcsv::Document& doc, size_t columns, size_t expected) {
+        vector<BloomFilter> filters(columns, BloomFilter(expected));
+        for (size_t r = 0; r < doc.GetRowCount(); r++) {
+            vector<string> row = doc.GetRow<string>(r);
+            for (size_t c = 0; c < row.size() && c < columns; c++) {
+                filters[c].add(row[c]);
+            }
+        }
+        return filters;
+    }
+
+    void save(const fs::path& path, const vector<BloomFilter>& filters) {
+        ofstream out(path, ios::binary);
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        uint32_t columns = filters.size();
+        uint32_t words = filters.empty() ? 0 : filters[0].words.size();
+        out.write(reinterpret_cast<const char*>(&columns), sizeof(columns));
+        out.write(reinterpret_cast<const char*>(&words), sizeof(words));
+        for (const BloomFilter& filter : filters) {
+            out.write(reinterpret_cast<const char*>(filter.words.data()), words * sizeof(uint64_t));
+        }
+    }
+
+    // false - файла нет, он от другой версии или повреждён
+    bool load(const fs::path& path, vector<BloomFilter>& filters) {
+        error_code ec;
+        uint64_t size = fs::file_size(path, ec);
+        ifstream in(path, ios::binary);
+        char magic[sizeof(kMagic)];
+        uint32_t version = 0, columns = 0, words = 0;
+        if (ec || !in.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), kMagic)
+            || !in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != kVersion
+            || !in.read(reinterpret_cast<char*>(&columns), sizeof(columns)) || !in.read(reinterpret_cast<char*>(&words), sizeof(words))
+            || size != sizeof(magic) + 3 * sizeof(uint32_t) + uint64_t(columns) * words * sizeof(uint64_t)) {
+            return false;
+        }
+        filters.assign(columns, BloomFilter());
+        for (BloomFilter& filter : filters) {
+            filter.words.resize(words);
+            in.read(reinterpret_cast<char*>(filter.words.data()), words * sizeof(uint64_t));
+        }
+        return bool(in);
+    }
+
+    // Фильтры файла из памяти или из N.bloom (под blooms.lock). Нет N.bloom - файл ещё
+    // дописывается, фильтра нет; N.bloom другой версии перестраивается по самому файлу.
+    vector<BloomFilter>& filtersFor(const Node* table, int csvNumber) {
+        ChunkBlooms& blooms = *table->blooms;
+        auto it = blooms.chunks.find(csvNumber);
+        if (it != blooms.chunks.end()) {
+            return it->second;
+        }
+        vector<BloomFilter>& filters = blooms.chunks[csvNumber];
+        fs::path path = bloomPath(table, csvNumber);
+        if (!load(path, filters)) {
+            filters.clear();
+            if (fs::exists(path)) {
+                rapidcsv::Document doc = readChunk(table, csvNumber);
+                filters = build(doc, table->stats->columns.size(), blooms.expected);
+                save(path, filters);
+            }
+        }
+        return filters;
+    }
+}
+
+BloomFilter::BloomFilter(size_t expected) : words((max<size_t>(expected, 1) * 10 + 63) / 64, 0) {}
+
+void BloomFilter::add(const string& value) {
+    auto [h1, h2] = hashes(value);
+    uint64_t bits = words.size() * 64;
+    for (int i = 0; i < kHashes; i++) {
+        uint64_t bit = (h1 + i * h2) % bits;
+        words[bit / 64] |= 1ULL << (bit % 64);
+    }
+}
+
+bool BloomFilter::mayContain(const string& value) const {
+    if (words.empty()) {
+        return true;
+    }
+    auto [h1, h2] = hashes(value);
+    uint64_t bits = words.size() * 64;
+    for (int i = 0; i < kHashes; i++) {
+        uint64_t bit = (h1 + i * h2) % bits;
+        if (!(words[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void initBlooms(Node* table, size_t expected) {
+    table->blooms = new ChunkBlooms;
+    table->blooms->expected = expected;
+}
+
+bool chunkMayContain(const Node* table, int csvNumber, int position, const string& value) {
+    lock_guard<mutex> guard(table->blooms->lock);
+    vector<BloomFilter>& filters = filtersFor(table, csvNumber);
+    return position < 0 || size_t(position) >= filters.size() || filters[position].mayContain(value);
+}
+
+bool chunkMayMatch(const Node* table, int csvNumber, int position, const Predicate& pred) {
+    if (!pred.exactValues()) {
+        return true;
+    }
+    for (const string& value : pred.values) {
+        if (chunkMayContain(table, csvNumber, position, value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void bloomSeal(const Node* table, int csvNumber) {
+    rapidcsv::Document doc = readChunk(table, csvNumber);
+    lock_guard<mutex> guard(table->blooms->lock);
+    vector<BloomFilter>& filters = table->blooms->chunks[csvNumber];
+    filters = build(doc, table->stats->columns.size(), table->blooms->expected);
+    save(bloomPath(table, csvNumber), filters);
+}
+
+bool bloomSealed(const Node* table, int csvNumber) {
+    lock_guard<mutex> guard(table->blooms->lock);
+    return !filtersFor(table, csvNumber).empty();
+}
+
+// Фильтр есть только у заполненного файла; у дописываемого перестраивать нечего
+void bloomRebuild(const Node* table, int csvNumber, rapidcsv::Document& doc) {
+    lock_guard<mutex> guard(table->blooms->lock);
+    vector<BloomFilter>& filters = table->blooms->chunks[csvNumber];
+    filters.clear();
+    if (fs::exists(bloomPath(table, csvNumber))) {
+        filters = build(doc, table->stats->columns.size(), table->blooms->expected);
+        save(bloomPath(table, csvNumber), filters);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "rapidcsv.h"
+#include "Node.h"
+#include "predicate.h"
+
+using namespace std;
+
+// Фильтр Блума: "нет" - значения точно нет, "да" - значение возможно есть
+class BloomFilter {
+public:
+    BloomFilter() = default;
+    explicit BloomFilter(size_t expected); // ~10 бит на значение, ~1% ложных срабатываний
+    void add(const string& value);
+    bool mayContain(const string& value) const;
+
+    vector<uint64_t> words;
+};
+
+// Фильтры по колонкам для каждого заполненного файла таблицы (N.bloom рядом с N.csv).
+// Фильтр строится один раз, когда файл заполняется до tuples_limit; у файла,
+// который ещё дописывается, фильтра нет и он читается всегда. В N.bloom записана
+// версия формата: файл от другой версии (другой хеш) не читается, а строится заново.
+struct ChunkBlooms {
+    mutex lock;
+    size_t expected = 0;                      // tuples_limit
+    map<int, vector<BloomFilter>> chunks;     // номер файла -> фильтр каждой колонки (пусто - фильтра нет)
+};
+
+void initBlooms(Node* table, size_t expected);
+// false - в файле точно нет строк со значением value в колонке position
+bool chunkMayContain(const Node* table, int csvNumber, int position, const string& value);
+bool chunkMayMatch(const Node* table, int csvNumber, int position, const Predicate& pred); // для = и IN, иначе true
+void bloomSeal(const Node* table, int csvNumber); // файл заполнен: фильтр строится и сохраняется в N.bloom
+bool bloomSealed(const Node* table, int csvNumber); // у файла есть фильтр - в него больше не дописывают
+void bloomRebuild(const Node* table, int csvNumber, rapidcsv::Document& doc); // после удаления строк
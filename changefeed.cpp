@@ -0,0 +1,116 @@
+#include "changefeed.h"
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // Запятая разделяет значения, перевод строки - записи, поэтому оба экранируются
+    void appendEscaped(string& line, const string& cell) {
+        for (char c : cell) {
+            if (c == ',' || c == '\\') {
+                line += '\\';
+                line += c;
+            } else if (c == '\n') {
+                line += "\\n";
+            } else {
+                line += c;
+            }
+        }
+    }
+
+    bool parseEvent(const string& line, uint64_t offset, ChangeEvent& event) {
+        if (line.size() < 2 || (line[0] != 'I' && line[0] != 'D') || line[1] != ',') {
+            return false;
+        }
+        event.offset = offset;
+        event.type = line[0] == 'I' ? ChangeType::Insert : ChangeType::Delete;
+        event.row.assign(1, "");
+        for (size_t i = 2; i < line.size(); i++) {
+            if (line[i] == ',') {
+                event.row.emplace_back();
+            } else if (line[i] == '\\' && i + 1 < line.size()) {
+                i++;
+                event.row.back() += line[i] == 'n' ? '\n' : line[i];
+            } else {
+                event.row.back() += line[i];
+            }
+        }
+        return true;
+    }
+}
+
+void initChangeFeed(Node* table) {
+    table->feed = new ChangeFeed;
+    table->feed->path = table->dir / (table->table + "_changes.log");
+    table->feed->log.open(table->feed->path, ios::trunc | ios::binary); // журнал пересоздаётся вместе с таблицей
+    if (!table->feed->log.is_open()) {
+        cerr << "Не удалось создать журнал изменений: " << table->feed->path << endl;
+    }
+}
+
+void feedAppend(const Node* table, ChangeType type, const vector<string>& row) {
+    ChangeFeed& feed = *table->feed;
+    string line(1, type == ChangeType::Insert ? 'I' : 'D');
+    for (const string& cell : row) {
+        line += ',';
+        appendEscaped(line, cell);
+    }
+    line += "\n";
+    {
+        lock_guard<mutex> guard(feed.lock);
+        if (!feed.log.write(line.data(), line.size()).flush()) { // flush: читатели открывают файл отдельно
+            cerr << "Не удалось записать журнал изменений: " << feed.path << endl;
+            feed.log.clear();
+            return;
+        }
+        feed.end += line.size();
+    }
+    feed.appended.notify_all();
+}
+
+ChangeBatch readChanges(const Node* table, uint64_t offset, size_t maxEvents) {
+    ChangeFeed& feed = *table->feed;
+    uint64_t end;
+    {
+        lock_guard<mutex> guard(feed.lock);
+        end = feed.end;
+    }
+
+    ChangeBatch batch;
+    batch.nextOffset = offset;
+    if (offset >= end) {
+        return batch;
+    }
+    ifstream log(feed.path, ios::binary);
+    if (!log.is_open()) {
+        cerr << "Не удалось открыть журнал изменений: " << feed.path << endl;
+        return batch;
+    }
+    log.seekg(offset);
+
+    // Читаем только до end: запись за этой границей может быть дописана не полностью
+    string line;
+    while (batch.events.size() < maxEvents && batch.nextOffset < end && getline(log, line)) {
+        ChangeEvent event;
+        if (parseEvent(line, batch.nextOffset, event)) {
+            batch.events.push_back(move(event));
+        } else {
+            cerr << "Повреждённая запись в журнале изменений на смещении " << batch.nextOffset << ".\n";
+        }
+        batch.nextOffset += line.size() + 1;
+    }
+    return batch;
+}
+
+ChangeSubscription::ChangeSubscription(const Node* table, uint64_t offset, size_t batchSize)
+    : table(table), position(offset), batchSize(max<size_t>(batchSize, 1)) {}
+
+ChangeBatch ChangeSubscription::poll(chrono::milliseconds timeout) {
+    ChangeFeed& feed = *table->feed;
+    {
+        unique_lock<mutex> guard(feed.lock);
+        feed.appended.wait_for(guard, timeout, [&] { return feed.end > position; });
+    }
+    ChangeBatch batch = readChanges(table, position, batchSize);
+    position = batch.nextOffset;
+    return batch;
+}
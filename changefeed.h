@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Node.h"
+
+using namespace std;
+
+// Журнал изменений таблицы (<table>_changes.log): каждая вставка и удаление
+// дописывается строкой "I,<table>_pk,значения..." или "D,<table>_pk,значения...";
+// запятая, перевод строки и \ в значениях экранируются обратной косой чертой.
+// Смещение события - его позиция в байтах внутри журнала, по нему потребитель
+// продолжает чтение. Журнал живёт, пока работает программа: parser пересоздаёт
+// директорию схемы при запуске, и журнал начинается заново вместе с таблицей.
+enum class ChangeType { Insert, Delete };
+
+struct ChangeEvent {
+    uint64_t offset;     // начало записи в журнале
+    ChangeType type;
+    vector<string> row;  // строка целиком, первым идёт <table>_pk
+};
+
+struct ChangeBatch {
+    vector<ChangeEvent> events;
+    uint64_t nextOffset = 0; // откуда читать следующую пачку
+};
+
+struct ChangeFeed {
+    mutex lock;
+    condition_variable appended; // будит подписчиков после записи
+    filesystem::path path;
+    ofstream log;                // открыт на всё время работы, запись под lock
+    uint64_t end = 0;            // размер журнала: записи дальше ещё не дописаны
+};
+
+void initChangeFeed(Node* table);
+void feedAppend(const Node* table, ChangeType type, const vector<string>& row);
+// Не больше maxEvents событий начиная со смещения offset
+ChangeBatch readChanges(const Node* table, uint64_t offset, size_t maxEvents);
+
+// Подписка на изменения таблицы с заданного смещения
+class ChangeSubscription {
+public:
+    ChangeSubscription(const Node* table, uint64_t offset = 0, size_t batchSize = 100);
+    // Ждёт новые события не дольше timeout; пустая пачка - за это время изменений не было
+    ChangeBatch poll(chrono::milliseconds timeout);
+    uint64_t offset() const { return position; }
+
+private:
+    const Node* table;
+    uint64_t position;
+    size_t batchSize;
+};
@@ -0,0 +1,362 @@
+#include "chunk.h"
+#include "insert.h"
+#include <lz4.h>
+#include <zstd.h>
+#include <sstream>
+
+namespace {
+    const char kMagic[4] = {'C', 'C', 'S', 'V'};
+    const int kFooterSize = sizeof(uint64_t) + sizeof(kMagic);
+
+    fs::path compressedPath(const Node* table, int csvNumber, char codec) {
+        return chunkPath(table, csvNumber).string() + (codec == 'Z' ? ".zst" : ".lz4");
+    }
+
+    // Формат файла из кеша; при первом обращении проверяется, какой файл есть на диске
+    char chunkCodec(const Node* table, int csvNumber) {
+        lock_guard<mutex> guard(table->formats->lock);
+        auto it = table->formats->codec.find(csvNumber);
+        if (it != table->formats->codec.end()) {
+            return it->second;
+        }
+        char codec = 0;
+        for (char candidate : {'L', 'Z'}) {
+            if (fs::exists(compressedPath(table, csvNumber, candidate))) {
+                codec = candidate;
+                break;
+            }
+        }
+        table->formats->codec[csvNumber] = codec;
+        return codec;
+    }
+
+    void setCodec(const Node* table, int csvNumber, char codec) {
+        lock_guard<mutex> guard(table->formats->lock);
+        table->formats->codec[csvNumber] = codec;
+    }
+
+    template <typename T>
+    void put(ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putString(ostream& out, const string& value) {
+        put<uint32_t>(out, value.size());
+        out.write(value.data(), value.size());
+    }
+
+    template <typename T>
+    T get(istream& in) {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    // Длина строки проверяется до выделения памяти: строка не может выходить за end
+    string getString(istream& in, uint64_t end) {
+        uint32_t size = get<uint32_t>(in);
+        if (!in || uint64_t(in.tellg()) + size > end) {
+            in.setstate(ios::failbit);
+            return {};
+        }
+        string value(size, '\0');
+        in.read(value.data(), value.size());
+        return value;
+    }
+
+    string compress(char codec, const string& raw) {
+        string packed;
+        if (codec == 'Z') {
+            packed.resize(ZSTD_compressBound(raw.size()));
+            size_t size = ZSTD_compress(packed.data(), packed.size(), raw.data(), raw.size(), 3);
+            packed.resize(ZSTD_isError(size) ? 0 : size);
+        } else {
+            packed.resize(LZ4_compressBound(raw.size()));
+            int size = LZ4_compress_default(raw.data(), packed.data(), raw.size(), packed.size());
+            packed.resize(size > 0 ? size : 0);
+        }
+        return packed;
+    }
+
+    bool decompress(char codec, const string& packed, uint32_t rawSize, string& raw) {
+        // Размер из индекса сверяется с данными до выделения памяти
+        if (codec == 'Z' ? ZSTD_getFrameContentSize(packed.data(), packed.size()) != rawSize
+                         : rawSize > uint64_t(packed.size()) * 255 + 16) { // lz4 сжимает не больше чем в 255 раз
+            return false;
+        }
+        raw.assign(rawSize, '\0');
+        if (codec == 'Z') {
+            size_t size = ZSTD_decompress(raw.data(), raw.size(), packed.data(), packed.size());
+            return !ZSTD_isError(size) && size == raw.size();
+        }
+        int size = LZ4_decompress_safe(packed.data(), raw.data(), packed.size(), raw.size());
+        return size >= 0 && size_t(size) == raw.size();
+    }
+
+    // Файл пишется под временным именем и заменяет старый одним rename
+    bool writeCompressed(const fs::path& path, char codec, const string& header, rapidcsv::Document& doc) {
+        fs::path tmpPath = path.string() + ".tmp";
+        ofstream out(tmpPath, ios::binary);
+        if (!out.is_open()) {
+            cerr << "Не удалось создать файл: " << tmpPath << "\n";
+            return false;
+        }
+        out.write(kMagic, sizeof(kMagic));
+        put<char>(out, codec);
+        putString(out, header);
+
+        size_t columns = doc.GetColumnCount();
+        vector<ChunkBlock> blocks;
+        for (size_t first = 0; first < doc.GetRowCount(); first += kBlockRows) {
+            ChunkBlock block;
+            block.min.resize(columns);
+            block.max.resize(columns);
+            string raw;
+            for (size_t r = first; r < doc.GetRowCount() && r < first + kBlockRows; r++) {
+                vector<string> row = doc.GetRow<string>(r);
+                row.resize(columns);
+                for (size_t c = 0; c < columns; c++) {
+                    if (block.rows == 0 || row[c] < block.min[c]) block.min[c] = row[c];
+                    if (block.rows == 0 || row[c] > block.max[c]) block.max[c] = row[c];
+                }
+                raw += csvLine(row) + "\n";
+                block.rows++;
+            }
+            string packed = compress(codec, raw);
+            block.offset = out.tellp();
+            block.packedSize = packed.size();
+            block.rawSize = raw.size();
+            out.write(packed.data(), packed.size());
+            blocks.push_back(block);
+        }
+
+        uint64_t indexOffset = out.tellp();
+        put<uint32_t>(out, blocks.size());
+        put<uint32_t>(out, columns);
+        for (const ChunkBlock& block : blocks) {
+            put(out, block.offset);
+            put(out, block.packedSize);
+            put(out, block.rawSize);
+            put(out, block.rows);
+            for (size_t c = 0; c < columns; c++) {
+                putString(out, block.min[c]);
+                putString(out, block.max[c]);
+            }
+        }
+        put(out, indexOffset);
+        out.write(kMagic, sizeof(kMagic));
+        out.close();
+        if (!out) {
+            cerr << "Не удалось записать файл: " << tmpPath << "\n";
+            error_code ec;
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (ec) {
+            cerr << "Не удалось заменить файл " << path << ": " << ec.message() << "\n";
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    bool removeFile(const fs::path& path) {
+        error_code ec;
+        fs::remove(path, ec);
+        if (ec) {
+            cerr << "Не удалось удалить файл " << path << ": " << ec.message() << "\n";
+        }
+        return !ec;
+    }
+
+    string headerLine(const fs::path& csvPath) {
+        ifstream file(csvPath);
+        string header;
+        getline(file, header);
+        return header;
+    }
+}
+
+void initChunkFormats(Node* table) {
+    table->formats = new ChunkFormats;
+}
+
+string csvLine(const vector<string>& row) {
+    string line;
+    for (size_t c = 0; c < row.size(); c++) {
+        if (c > 0) {
+            line += ',';
+        }
+        const string& value = row[c];
+        if (value.find_first_of(",\"\n") == string::npos) {
+            line += value;
+            continue;
+        }
+        line += '"';
+        for (char ch : value) {
+            line += ch == '"' ? "\"\"" : string(1, ch);
+        }
+        line += '"';
+    }
+    return line;
+}
+
+bool isCompressed(const Node* table, int csvNumber) {
+    return chunkCodec(table, csvNumber) != 0;
+}
+
+bool chunkExists(const Node* table, int csvNumber) {
+    return isCompressed(table, csvNumber) || fs::exists(chunkPath(table, csvNumber));
+}
+
+bool readChunkIndex(const Node* table, int csvNumber, ChunkIndex& index) {
+    char codec = chunkCodec(table, csvNumber);
+    fs::path path = compressedPath(table, csvNumber, codec);
+    error_code ec;
+    uint64_t fileSize = codec ? fs::file_size(path, ec) : 0;
+    ifstream in(path, ios::binary);
+    char magic[sizeof(kMagic)];
+    if (!codec || ec || fileSize < sizeof(kMagic) + 1 + sizeof(uint32_t) + kFooterSize
+        || !in.is_open() || !in.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), kMagic)) {
+        cerr << "Повреждён сжатый файл: " << path << "\n";
+        return false;
+    }
+
+    // Футер: смещение индекса и повтор магии - файл записан до конца
+    uint64_t indexEnd = fileSize - kFooterSize;
+    in.seekg(indexEnd);
+    uint64_t indexOffset = get<uint64_t>(in);
+    in.read(magic, sizeof(magic));
+    if (!in || !equal(magic, magic + sizeof(magic), kMagic) || indexOffset > indexEnd || indexEnd - indexOffset < 2 * sizeof(uint32_t)) {
+        cerr << "Повреждён футер сжатого файла: " << path << "\n";
+        return false;
+    }
+
+    in.seekg(sizeof(kMagic));
+    index.codec = get<char>(in);
+    index.header = getString(in, indexOffset);
+    uint64_t dataStart = in ? uint64_t(in.tellg()) : 0;
+
+    in.seekg(indexOffset);
+    uint32_t count = get<uint32_t>(in);
+    uint32_t columns = get<uint32_t>(in);
+    // Запись блока занимает не меньше minEntry байт, поэтому число блоков и колонок ограничено размером индекса
+    uint64_t minEntry = sizeof(uint64_t) + 3 * sizeof(uint32_t) + 2 * sizeof(uint32_t) * uint64_t(columns);
+    if (!in || index.codec != codec || uint64_t(count) * minEntry > indexEnd - indexOffset - 2 * sizeof(uint32_t)) {
+        cerr << "Повреждён индекс блоков: " << path << "\n";
+        return false;
+    }
+    index.blocks.resize(count);
+    for (ChunkBlock& block : index.blocks) {
+        block.offset = get<uint64_t>(in);
+        block.packedSize = get<uint32_t>(in);
+        block.rawSize = get<uint32_t>(in);
+        block.rows = get<uint32_t>(in);
+        block.min.resize(columns);
+        block.max.resize(columns);
+        for (uint32_t c = 0; c < columns; c++) {
+            block.min[c] = getString(in, indexEnd);
+            block.max[c] = getString(in, indexEnd);
+        }
+        if (block.offset < dataStart || block.offset > indexOffset || indexOffset - block.offset < block.packedSize) {
+            in.setstate(ios::failbit); // сжатые данные блока должны лежать между заголовком и индексом
+        }
+    }
+    if (!in) {
+        cerr << "Повреждён индекс блоков: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+rapidcsv::Document readChunk(const Node* table, int csvNumber, OperatorStats* stats, const BlockFilter& need, bool* complete) {
+    if (complete) {
+        *complete = true;
+    }
+    char codec = chunkCodec(table, csvNumber);
+    if (!codec) {
+        fs::path path = chunkPath(table, csvNumber);
+        if (stats) {
+            countChunk(*stats, path);
+        }
+        return rapidcsv::Document(path.string());
+    }
+
+    ChunkIndex index;
+    stringstream text;
+    if (!readChunkIndex(table, csvNumber, index)) {
+        if (complete) {
+            *complete = false;
+        }
+        return rapidcsv::Document(text);
+    }
+    text << index.header << "\n";
+    if (stats) {
+        stats->chunksOpened++;
+    }
+
+    ifstream in(compressedPath(table, csvNumber, codec), ios::binary);
+    for (const ChunkBlock& block : index.blocks) {
+        if (need && !need(block)) {
+            continue; // блок не может содержать нужных строк
+        }
+        string packed(block.packedSize, '\0'); // размер проверен по положению индекса в файле
+        string raw;
+        in.seekg(block.offset);
+        in.read(packed.data(), packed.size());
+        if (!in || !decompress(index.codec, packed, block.rawSize, raw)) {
+            cerr << "Не удалось распаковать блок чанка " << csvNumber << " таблицы " << table->table << "\n";
+            if (complete) {
+                *complete = false;
+            }
+            continue;
+        }
+        if (stats) {
+            stats->bytesRead += block.packedSize;
+        }
+        text << raw;
+    }
+    return rapidcsv::Document(text);
+}
+
+void writeChunk(const Node* table, int csvNumber, rapidcsv::Document& doc) {
+    char codec = chunkCodec(table, csvNumber);
+    if (!codec) {
+        doc.Save(chunkPath(table, csvNumber).string());
+        return;
+    }
+    ChunkIndex index;
+    if (readChunkIndex(table, csvNumber, index)) {
+        writeCompressed(compressedPath(table, csvNumber, codec), codec, index.header, doc);
+    }
+}
+
+// Если файл уже был сжат, а затем заменён новым N.csv, сжатая копия перезаписывается
+void sealChunk(const Node* table, int csvNumber) {
+    fs::path csvPath = chunkPath(table, csvNumber);
+    if (table->compression.empty() || !fs::exists(csvPath)) {
+        return;
+    }
+    rapidcsv::Document doc(csvPath.string());
+    char codec = table->compression == "zstd" ? 'Z' : 'L';
+    if (writeCompressed(compressedPath(table, csvNumber, codec), codec, headerLine(csvPath), doc)) {
+        setCodec(table, csvNumber, codec); // читатели переходят на сжатый файл до удаления N.csv
+        removeFile(csvPath);
+    }
+}
+
+bool dropCompressed(const Node* table, int csvNumber) {
+    bool removed = true;
+    for (char codec : {'L', 'Z'}) {
+        removed = removeFile(compressedPath(table, csvNumber, codec)) && removed;
+    }
+    setCodec(table, csvNumber, 0);
+    return removed;
+}
+
+bool removeChunk(const Node* table, int csvNumber) {
+    bool removed = removeFile(chunkPath(table, csvNumber));
+    return dropCompressed(table, csvNumber) && removed;
+}
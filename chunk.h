@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "rapidcsv.h"
+#include "Node.h"
+#include "profiler.h"
+
+using namespace std;
+
+// Сжатый формат чанка (N.csv.lz4 / N.csv.zst). Пока чанк заполняется, он хранится
+// обычным N.csv; когда строк становится tuples_limit, чанк запечатывается:
+// строки делятся на блоки по kBlockRows, каждый блок сжимается отдельно, а в конце
+// файла пишется индекс блоков с min/max каждой колонки. Чтение распаковывает
+// только те блоки, которые нужны запросу. Файл заканчивается смещением индекса
+// и повтором магии; оборванный или повреждённый файл не читается.
+const size_t kBlockRows = 256;
+
+// Запись индекса блоков
+struct ChunkBlock {
+    uint64_t offset = 0;       // смещение сжатых данных в файле
+    uint32_t packedSize = 0;
+    uint32_t rawSize = 0;
+    uint32_t rows = 0;
+    vector<string> min, max;   // по колонкам
+};
+
+struct ChunkIndex {
+    char codec = 0;            // 'L' - lz4, 'Z' - zstd
+    string header;             // строка с названиями колонок
+    vector<ChunkBlock> blocks;
+};
+
+using BlockFilter = function<bool(const ChunkBlock&)>; // true - блок нужно читать
+
+// Формат файлов таблицы запоминается при первой проверке, чтобы чтение
+// не обращалось к файловой системе за ним каждый раз
+struct ChunkFormats {
+    mutex lock;
+    unordered_map<int, char> codec; // номер файла -> 0 (N.csv), 'L', 'Z'; нет записи - не проверялся
+};
+
+void initChunkFormats(Node* table);
+string csvLine(const vector<string>& row); // строка CSV без перевода строки, значения с , " и \n в кавычках
+bool isCompressed(const Node* table, int csvNumber);
+bool chunkExists(const Node* table, int csvNumber);
+bool readChunkIndex(const Node* table, int csvNumber, ChunkIndex& index);
+// Чтение чанка в любом формате; для сжатого распаковываются только блоки, прошедшие need.
+// complete = false: индекс или какой-то блок не прочитан, в документе не все строки файла -
+// такой документ нельзя сохранять обратно через writeChunk
+rapidcsv::Document readChunk(const Node* table, int csvNumber, OperatorStats* stats = nullptr, const BlockFilter& need = nullptr,
+                             bool* complete = nullptr);
+void writeChunk(const Node* table, int csvNumber, rapidcsv::Document& doc); // сохранение в текущем формате чанка
+void sealChunk(const Node* table, int csvNumber); // сжатие заполненного N.csv
+bool dropCompressed(const Node* table, int csvNumber); // N.csv заменил сжатый файл: сжатая копия удаляется
+bool removeChunk(const Node* table, int csvNumber); // удаление файла в любом формате; false - что-то не удалилось
@@ -1,4 +1,4 @@
-#include "delete.h"
+#include "delet.h"
 
 bool ExistColonk(const string& tableName, const string& columnName, Node* Tablehead) {
     if (!Tablehead) {
@@ -34,7 +34,7 @@ bool ExistColonk(const string& tableName, const string& columnName, Node* Tableh
 
 
 // Функция для парсинга WHERE части команды
-bool parseWhereClause(istringstream& iss2, string& table, string& column, string& value, const string& tableName, const TableJson& json_table) {
+bool parseWhereClause(istringstream& iss2, string& table, string& column, Predicate& pred, const string& tableName, const TableJson& json_table) {
     string indication;
     iss2 >> indication;
 
@@ -59,48 +59,59 @@ bool parseWhereClause(istringstream& iss2, string& table, string& column, string
         return false;
     }
 
-    // Проверка знака "="
+    // Оператор (=, <, >, BETWEEN, LIKE, IN) и значения в кавычках
     iss2 >> indication;
-    if (indication != "=") {
-        cerr << "Некорректная команда.\n";
-        return false;
-    }
-
-    // Проверка кавычек вокруг значения
-    iss2 >> value;
-    if (value.front() != '\'' || value.back() != '\'') {
-        cerr << "Некорректная команда.\n";
-        return false;
-    }
-
-    // Убираем кавычки из значения
-    value = value.substr(1, value.size() - 2);
-    return true;
+    return parsePredicate(indication, iss2, pred);
 }
 
 
-bool deleteRowsFromTable(const string& tableName, const string& column, const string& value, const TableJson& json_table) {
-    int amountCsv = 1;
+bool deleteRowsFromTable(const Node* table, const string& column, const Predicate& pred, OperatorStats& stats) {
     bool deletedStr = false;
-
-    // Ищем все CSV файлы
-    while (true) {
-        fs::path filePath = fs::path("/mnt/c/Users/Николай/practice 2/Practice 1.3") / json_table.Name / tableName / (to_string(amountCsv) + ".csv");
-        ifstream file(filePath);
-        if (!file.is_open()) {
-            break;
-        }
-        file.close();
-        amountCsv++;
+    int position = columnPosition(table, column);
+
+    // Ищем все CSV файлы; при индексе по колонке - только файлы с подходящими строками
+    vector<int> chunks;
+    if (hasIndex(table, position)) {
+        set<int> found = indexLookup(table, position, pred);
+        chunks.assign(found.begin(), found.end());
+    } else {
+        chunks = chunksFor(table, position, pred); // по ключу разбиения - только нужные партиции
     }
 
-    // Просматриваем все CSV файлы
-    for (size_t iCsv = 1; iCsv < amountCsv; iCsv++) {
-        string filePath = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + tableName + "/" + (to_string(iCsv) + ".csv");
-        rapidcsv::Document doc(filePath);
+    // Просматриваем выбранные CSV файлы
+    for (int iCsv : chunks) {
+        // Фильтр Блума отвечает без чтения файла, если значения там точно нет
+        if (!chunkMayMatch(table, iCsv, position, pred)) {
+            stats.chunksSkipped++;
+            continue;
+        }
+        // Сжатый чанк пропускаем, если ни один блок по min/max не может содержать значение
+        if (isCompressed(table, iCsv)) {
+            ChunkIndex index;
+            if (!readChunkIndex(table, iCsv, index)) {
+                continue;
+            }
+            bool candidate = false;
+            for (const ChunkBlock& block : index.blocks) {
+                candidate = candidate || pred.mayOverlap(block.min[position], block.max[position]);
+            }
+            if (!candidate) {
+                stats.chunksSkipped++;
+                continue;
+            }
+        }
+        bool complete;
+        rapidcsv::Document doc = readChunk(table, iCsv, &stats, nullptr, &complete);
+        if (!complete) {
+            // Перезапись прочитанной части стёрла бы строки из повреждённых блоков
+            cerr << "Файл " << iCsv << " таблицы " << table->table << " повреждён, строки из него не удаляются.\n";
+            continue;
+        }
+        vector<Row> removed; // попадут в журнал изменений после записи файла
 
         int columnIndex = doc.GetColumnIdx(column);
         size_t amountRow = doc.GetRowCount();
+        stats.rowsIn += amountRow;
 
         if (columnIndex == -1) {
             cerr << "Колонка не найдена в файле CSV: " << column << "\n";
@@ -110,65 +121,95 @@ bool deleteRowsFromTable(const string& tableName, const string& column, const st
         // Ищем и удаляем строки с нужным значением
         // Важно: изменяем цикл, чтобы корректно работать с индексами после удаления строк
         for (size_t i = 0; i < amountRow;) {  // Индекс не увеличивается сразу
-            if (doc.GetCell<string>(columnIndex, i) == value) {
+            if (pred.matches(doc.GetCell<string>(columnIndex, i))) {
+                vector<string> row = doc.GetRow<string>(i);
+                statsOnDelete(table, row);
+                indexOnDelete(table, row);
+                removed.push_back(move(row));
                 doc.RemoveRow(i);
                 deletedStr = true;
+                stats.rowsOut++;
                 amountRow--;  // Уменьшаем количество строк
                 // Не увеличиваем индекс i, чтобы повторно проверить строку, которая переместилась на место удалённой
             } else {
                 i++;  // Только увеличиваем индекс, если строка не удалена
             }
         }
-        doc.Save(filePath);  // Сохраняем изменения в файл
+        if (!removed.empty()) {
+            writeChunk(table, iCsv, doc);  // Сохраняем изменения в файл в том же формате
+            bloomRebuild(table, iCsv, doc);
+            for (const Row& row : removed) {
+                feedAppend(table, ChangeType::Delete, row);
+            }
+        }
     }
 
     return deletedStr;
 }
 
 
-void delet(const string& command, const TableJson& json_table) {
+bool delet(const string& command, const TableJson& json_table) {
+    QueryScope scope(command);
+    OperatorStats& stats = profileOperator("Delete");
+    ScopedTimer timer(stats.time);
+
     istringstream iss(command);
     string indication;
 
     // Проверка и разбор команды DELETE FROM
     if (!(iss >> indication && indication == "DELETE" && iss >> indication && indication == "FROM")) {
         cerr << "Некорректная команда.\n";
-        return;
+        return false;
     }
 
     string tableName;
     iss >> tableName;
-    if (!TableExist(tableName, json_table.Tablehead)) {
+    Node* tableNode = FindTable(json_table.Tablehead, tableName);
+    if (!tableNode) {
         cerr << "Такой таблицы нет.\n";
-        return;
+        return false;
     }
 
-    // Разбор второй части команды: WHERE <table.column> = '<value>'
+    // Разбор второй части команды: WHERE <table.column> <оператор> '<value>'
     string whereCmd;
     if (!(iss >> whereCmd && whereCmd == "WHERE")) {
         cerr << "Некорректная команда.\n";
-        return;
+        return false;
+    }
+
+    string table, column;
+    Predicate pred;
+    if (!parseWhereClause(iss, table, column, pred, tableName, json_table)) {
+        return false;  // Ошибка уже выведена в parseWhereClause
     }
 
-    string table, column, value;
-    if (!parseWhereClause(iss, table, column, value, tableName, json_table)) {
-        return;  // Ошибка уже выведена в parseWhereClause
+    // Таблица в памяти защищена своей блокировкой, файл блокировки не нужен
+    if (isInMemory(tableNode)) {
+        if (!memDelete(tableNode, columnPosition(tableNode, column), pred, stats)) {
+            cout << "Указанное значение не найдено.\n";
+        }
+        return true;
     }
 
     // Проверка на блокировку таблицы
-    if (isloker(tableName, json_table.Name)) {
-        cerr << "Таблица заблокирована.\n";
-        return;
+    {
+        ScopedTimer lockTimer(stats.lockIo);
+        if (isloker(tableNode)) {
+            cerr << "Таблица заблокирована.\n";
+            return false;
+        }
+        loker(tableNode); // Блокировка таблицы
     }
-    loker(tableName, json_table.Name); // Блокировка таблицы
 
     // Попытка удалить строки из всех CSV файлов таблицы
-    bool deletedStr = deleteRowsFromTable(tableName, column, value, json_table);
+    bool deletedStr = deleteRowsFromTable(tableNode, column, pred, stats);
 
     if (!deletedStr) {
         cout << "Указанное значение не найдено.\n";
     }
 
     // Разблокировка таблицы
-    loker(tableName, json_table.Name);
+    ScopedTimer lockTimer(stats.lockIo);
+    loker(tableNode);
+    return true;
 }
@@ -7,6 +7,6 @@
 using namespace std;
 
 bool ExistColonk(const string& tableName, const string& columnName, Node* Tablehead);
-bool parseWhereClause(istringstream& iss2, string& table, string& column, string& value, const string& tableName, const TableJson& json_table);
-bool deleteRowsFromTable(const string& tableName, const string& column, const string& value, const TableJson& json_table);
-void delet(const string& command, const TableJson& json_table) ;
+bool parseWhereClause(istringstream& iss2, string& table, string& column, Predicate& pred, const string& tableName, const TableJson& json_table);
+bool deleteRowsFromTable(const Node* table, const string& column, const Predicate& pred, OperatorStats& stats);
+bool delet(const string& command, const TableJson& json_table) ; // false - команда не выполнена (отсутствие строк ошибкой не считается)
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// FNV-1a: в отличие от std::hash результат не зависит от компилятора и
+// стандартной библиотеки, поэтому годится для всего, что попадает на диск
+inline uint64_t stableHash(const string& value) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
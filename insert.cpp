@@ -1,19 +1,27 @@
 #include "insert.h"
 
-bool TableExist(const string& tableName, Node* tableHead) {
+Node* FindTable(Node* tableHead, const string& tableName) {
     Node* current = tableHead;
     while (current) {
         if (current->table == tableName) {
-            return true;
+            return current;
         }
         current = current->next;
     }
-    return false;
+    return nullptr;
 }
 
-bool isloker(const string& tableName, const string& schemeName) {
-    string baseDir = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + schemeName + "/" + tableName;
-    string lockFile = baseDir + "/" + (tableName + "_lock.txt");
+bool TableExist(const string& tableName, Node* tableHead) {
+    return FindTable(tableHead, tableName) != nullptr;
+}
+
+// Путь к csv файлу с номером csvNumber внутри директории таблицы (или её партиции)
+fs::path chunkPath(const Node* table, int csvNumber) {
+    return partitionDir(table, csvNumber / kPartitionChunks) / (to_string(csvNumber % kPartitionChunks) + ".csv");
+}
+
+bool isloker(const Node* table) {
+    const fs::path& lockFile = table->lockFile;
 
     if (!fs::exists(lockFile)) {
         cerr << "Ошибка: файл блокировки не существует: " << lockFile << ".\n";
@@ -32,9 +40,8 @@ bool isloker(const string& tableName, const string& schemeName) {
     return current == "locked";
 }
 
-void loker(const string& tableName, const string& schemeName) {
-    string baseDir = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + schemeName + "/" + tableName;
-    string lockFile = baseDir + "/" + (tableName + "_lock.txt");
+void loker(const Node* table) {
+    const fs::path& lockFile = table->lockFile;
 
     if (!fs::exists(lockFile)) {
         cerr << "Ошибка: файл блокировки не существует: " << lockFile << "\n";
@@ -81,20 +88,16 @@ void copyNameColonk(const string& from_file, const string& to_file) {
     fileT.close();
 }
 
-int findCsvFileCount(const TableJson& json_table, const string& tableName) {
+int findCsvFileCount(const Node* table, int partition) {
     int csvCount = 0;
-    int csvNumber = 1;
+    int csvNumber = partition * kPartitionChunks + 1;
 
     while (true) {
-        string csvFile = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + tableName + "/" + (to_string(csvNumber) + ".csv");
-
         // Проверяем, существует ли файл
-        ifstream fileIn(csvFile);
-        if (!fileIn.is_open()) {
+        if (!chunkExists(table, csvNumber)) {
             // Файл не существует, выходим из цикла, так как дальше файлов нет
             break;
         }
-        fileIn.close();  // Закрываем файл после проверки
 
         // Увеличиваем счётчик найденных файлов
         csvCount++;
@@ -107,50 +110,70 @@ int findCsvFileCount(const TableJson& json_table, const string& tableName) {
     return csvCount;
 }
 
-void createNewCsvFile(const string& baseDir, const string& tableName, int& csvNumber, const TableJson& tableJson) {
+// Выбирает файл для новой строки; rows - количество строк, уже записанных в него
+bool createNewCsvFile(const Node* table, int& csvNumber, const TableJson& tableJson, size_t& rows) {
     // Получаем максимальное количество строк на файл из структуры TableJson
-    int maxRowsPerFile = tableJson.TableSize;
-    
-    // Формируем путь к текущему CSV файлу
-    string csvFile = baseDir + "/" + tableName + "/" + to_string(csvNumber) + ".csv";
-    
-    // Проверяем количество строк в текущем файле
-    rapidcsv::Document doc(csvFile);
-    if (doc.GetRowCount() >= maxRowsPerFile) {
-        // Если достигнут лимит строк, увеличиваем номер файла
+    size_t maxRowsPerFile = tableJson.TableSize;
+    rows = 0;
+
+    if (csvNumber % kPartitionChunks == 0) {
+        // Таблица (партиция) ещё пустая - первый файл создаём ниже
+        csvNumber++;
+    } else if (isCompressed(table, csvNumber) || bloomSealed(table, csvNumber)) {
+        // Файл уже заполнялся до лимита (сжат, построен фильтр Блума), дописывать в него нельзя,
+        // даже если после DELETE в нём стало меньше строк
         csvNumber++;
-        csvFile = baseDir + "/" + tableName + "/" + to_string(csvNumber) + ".csv";
+    } else {
+        // Проверяем количество строк в текущем файле
+        rapidcsv::Document doc(chunkPath(table, csvNumber).string());
+        rows = doc.GetRowCount();
+        if (rows >= maxRowsPerFile) {
+            // Если достигнут лимит строк, увеличиваем номер файла
+            csvNumber++;
+            rows = 0;
+        }
+    }
+
+    // Номер файла за пределами партиции совпал бы с номером файла следующей
+    if (csvNumber % kPartitionChunks == 0) {
+        return false;
     }
 
     // Если файла нет, создаём его
+    fs::path csvFile = chunkPath(table, csvNumber);
     if (!fs::exists(csvFile)) {
         // Создаём новый файл и копируем в него названия колонок
-        string csvFirst = baseDir + "/" + tableName + "/1.csv";
-        copyNameColonk(csvFirst, csvFile);
+        copyNameColonk(table->header.string(), csvFile.string());
     }
+    return true;
 }
 
-void insert(const string& command, TableJson json_table) {
+bool insert(const string& command, TableJson json_table) {
+    QueryScope scope(command);
+    OperatorStats& stats = profileOperator("Insert");
+    ScopedTimer timer(stats.time);
+
     istringstream iss(command);
     string slovo;
     iss >> slovo >> slovo;
 
     if (slovo != "INTO") {
         cerr << "Некорректная команда.\n";
-        return;
+        return false;
     }
 
     string tableName;
     iss >> tableName;
-    if (!TableExist(tableName, json_table.Tablehead)) {
+    Node* table = FindTable(json_table.Tablehead, tableName);
+    if (!table) {
         cerr << "Такой таблицы нет.\n";
-        return;
+        return false;
     }
 
     iss >> slovo;
     if (slovo != "VALUES") {
         cerr << "Некорректная команда.\n";
-        return;
+        return false;
     }
 
     string values;
@@ -160,69 +183,94 @@ void insert(const string& command, TableJson json_table) {
 
     if (values.front() != '(' || values.back() != ')') {
         cerr << "Некорректная команда.\n";
-        return;
+        return false;
     }
 
-    if (isloker(tableName, json_table.Name)) {
-        cerr << "Таблица заблокирована.\n";
-        return;
+    // Разбираем значения в кавычках, первой идёт специальная колонка (ключ назначается ниже)
+    Row row{""};
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] == '\'') {
+            i++;
+            string cell;
+            while (i < values.size() && values[i] != '\'') {
+                cell += values[i++];
+            }
+            row.push_back(cell);
+        }
     }
 
-    loker(tableName, json_table.Name);
+    // Таблица в памяти: без файла блокировки, последовательности и чтения csv
+    if (isInMemory(table)) {
+        memInsert(table, row);
+        stats.rowsOut++;
+        return true;
+    }
+
+    {
+        ScopedTimer lockTimer(stats.lockIo);
+        if (isloker(table)) {
+            cerr << "Таблица заблокирована.\n";
+            return false;
+        }
+        loker(table);
+    }
 
     int currentPK;
-    string PKFile = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + tableName + "/" + (tableName + "_pk_sequence.txt");
-    ifstream fileIn(PKFile);
+    ifstream fileIn(table->pkFile);
     if (!fileIn.is_open()) {
         cerr << "Не удалось открыть файл.\n";
-        return;
+        return false;
     }
 
     fileIn >> currentPK;
     fileIn.close();
 
-    ofstream fileOut(PKFile);
+    ofstream fileOut(table->pkFile);
     if (!fileOut.is_open()) {
         cerr << "Не удалось открыть файл.\n";
-        return;
+        return false;
     }
     currentPK++;
     fileOut << currentPK;
     fileOut.close();
+    row[0] = to_string(currentPK); // до выбора партиции: ключом разбиения может быть <table>_pk
 
-    // Логика для определения количества существующих файлов
-    int csvNumber = findCsvFileCount(json_table, tableName);
-
-    string baseDir = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name;
+    // Логика для определения количества существующих файлов; строка попадает в партицию по хешу ключа
+    int partition = rowPartition(table, row);
+    int csvNumber = partition * kPartitionChunks + findCsvFileCount(table, partition);
 
     // Используем новую функцию для создания нового CSV файла, если нужно
-    createNewCsvFile(baseDir, tableName, csvNumber, json_table);
-
-    string csvSecond = baseDir + "/" + tableName + "/" + to_string(csvNumber) + ".csv";
+    size_t rowsInFile = 0;
+    if (!createNewCsvFile(table, csvNumber, json_table, rowsInFile)) {
+        cerr << "В партиции " << partition << " таблицы " << tableName << " уже " << kPartitionChunks - 1 << " файлов, новый создать нельзя.\n";
+        ScopedTimer lockTimer(stats.lockIo);
+        loker(table);
+        return false;
+    }
 
     // Открываем CSV файл для записи
-    ofstream csv(csvSecond, ios::app);
+    ofstream csv(chunkPath(table, csvNumber), ios::app);
     if (!csv.is_open()) {
         cerr << "Не удалось открыть файл.\n";
-        return;
+        return false;
     }
 
     // Записываем данные в CSV файл
-    csv << currentPK << ",";
-    for (int i = 0; i < values.size(); i++) {
-        if (values[i] == '\'') {
-            i++;
-            while (i < values.size() && values[i] != '\'') {
-                csv << values[i++];
-            }
-            if (i + 1 < values.size() && values[i + 1] != ')') {
-                csv << ",";
-            } else {
-                csv << endl;
-            }
-        }
-    }
+    csv << csvLine(row) << "\n"; // значения с запятой или кавычкой - в кавычках
 
     csv.close();
-    loker(tableName, json_table.Name);
+    statsOnInsert(table, row);
+    indexOnInsert(table, csvNumber, row);
+    feedAppend(table, ChangeType::Insert, row);
+
+    // Заполненный файл: строим фильтр Блума и сжимаем, если для таблицы задано сжатие
+    if (rowsInFile + 1 >= size_t(json_table.TableSize)) {
+        bloomSeal(table, csvNumber);
+        sealChunk(table, csvNumber);
+    }
+    stats.rowsOut++;
+
+    ScopedTimer lockTimer(stats.lockIo);
+    loker(table);
+    return true;
 }
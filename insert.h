@@ -1,15 +1,28 @@
 #pragma once
 #include <iostream>
 #include <filesystem>
-#include "rapidcsv.h" 
+#include "rapidcsv.h"
 #include "Node.h"
+#include "profiler.h"
+#include "planner.h"
+#include "chunk.h"
+#include "bloom.h"
+#include "ordered_index.h"
+#include "changefeed.h"
+#include "memtable.h"
+#include "partition.h"
 
 using namespace std;
 namespace fs = filesystem;
 
+Node* FindTable(Node* tableHead, const string& tableName);
 bool TableExist(const string& tableName, Node* tableHead);
-bool isloker(const string& tableName, const string& schemeName);
+fs::path chunkPath(const Node* table, int csvNumber);
+bool isloker(const Node* table);
 void copyNameColonk(const string& from_file, const string& to_file);
-void loker(const string& tableName, const string& schemeName);
-int findNextCsvNumber(TableJson json_table, const string& tableName);
-void insert(const string& command, TableJson json_table);
+void loker(const Node* table);
+int findCsvFileCount(const Node* table, int partition = 0);
+// Выбор файла для новой строки (csvNumber) и число строк, уже записанных в него;
+// false - в партиции уже kPartitionChunks - 1 файлов, новый создать нельзя
+bool createNewCsvFile(const Node* table, int& csvNumber, const TableJson& tableJson, size_t& rows);
+bool insert(const string& command, TableJson json_table); // false - команда не выполнена
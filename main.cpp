@@ -0,0 +1,24 @@
+#include "parcer.h"
+#include "memtable.h"
+
+// Консоль СУБД: схема берётся из schema.json, команды читаются построчно до EXIT
+int main() {
+    TableJson json_table{};
+    parser(json_table);
+    if (json_table.Tablehead == nullptr) {
+        return 1;
+    }
+
+    string command;
+    while (true) {
+        cout << "> ";
+        if (!getline(cin, command) || command == "EXIT") {
+            break;
+        }
+        if (!command.empty()) {
+            executeCommand(command, json_table);
+        }
+    }
+    shutdownMemTables(json_table); // последний снимок таблиц в памяти
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "memtable.h"
+#include "insert.h"
+#include "changefeed.h"
+#include <algorithm>
+
+namespace {
+    // Изменение начиная со строки first: снимок перепишет файлы с этой строки
+    void markDirty(MemTable& mem, size_t first) {
+        size_t current = mem.dirtyFrom;
+        while (first < current && !mem.dirtyFrom.compare_exchange_weak(current, first)) {
+        }
+    }
+
+    // Исключение из потока снимков завершило бы программу: снимок повторяется целиком на следующем шаге
+    void snapshotLoop(const Node* table) {
+        MemTable& mem = *table->mem;
+        unique_lock<mutex> guard(mem.stopLock);
+        while (!mem.stopSignal.wait_for(guard, mem.interval, [&] { return mem.stopping; })) {
+            guard.unlock();
+            try {
+                snapshotTable(table);
+            } catch (const exception& e) {
+                cerr << "Снимок таблицы " << table->table << " не записан: " << e.what() << "\n";
+                markDirty(mem, 0);
+            }
+            guard.lock();
+        }
+    }
+
+    // Файл пишется рядом под временным именем и одним rename заменяет старый N.csv;
+    // сжатая копия прошлого снимка удаляется уже после замены
+    bool writeCsv(const Node* table, int csvNumber, const string& header, vector<Row>::const_iterator first, vector<Row>::const_iterator last) {
+        fs::path tmpPath = chunkPath(table, csvNumber).string() + ".tmp";
+        ofstream csv(tmpPath);
+        if (!csv.is_open()) {
+            cerr << "Не удалось открыть файл: " << tmpPath << "\n";
+            return false;
+        }
+        csv << header << "\n";
+        for (auto row = first; row != last; ++row) {
+            csv << csvLine(*row) << "\n";
+        }
+        csv.close();
+        if (!csv) {
+            cerr << "Не удалось записать файл: " << tmpPath << "\n";
+            error_code ec;
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        error_code ec;
+        fs::rename(tmpPath, chunkPath(table, csvNumber), ec);
+        if (ec) {
+            cerr << "Не удалось заменить файл " << chunkPath(table, csvNumber) << ": " << ec.message() << "\n";
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        return !isCompressed(table, csvNumber) || dropCompressed(table, csvNumber);
+    }
+}
+
+void initMemTable(Node* table, size_t chunkRows, chrono::milliseconds interval) {
+    table->mem = new MemTable;
+    table->mem->chunkRows = max<size_t>(chunkRows, 1);
+    table->mem->interval = interval;
+    table->mem->snapshotter = thread(snapshotLoop, table);
+}
+
+bool isInMemory(const Node* table) {
+    return table->mem != nullptr;
+}
+
+void memInsert(const Node* table, Row& row) {
+    MemTable& mem = *table->mem;
+    {
+        unique_lock<shared_mutex> guard(mem.lock);
+        row.resize(max(row.size(), table->stats->columns.size())); // недостающие значения - пустые
+        row[0] = to_string(++mem.lastPk);
+        mem.rows.push_back(row);
+        markDirty(mem, mem.rows.size() - 1);
+        feedAppend(table, ChangeType::Insert, row); // под блокировкой, чтобы порядок событий совпадал с порядком ключей
+    }
+    statsOnInsert(table, row);
+}
+
+bool memDelete(const Node* table, int position, const Predicate& pred, OperatorStats& stats) {
+    MemTable& mem = *table->mem;
+    vector<Row> removed;
+    {
+        unique_lock<shared_mutex> guard(mem.lock);
+        stats.rowsIn += mem.rows.size();
+        // Строки за первой удалённой сдвинутся: снимок перепишет файлы с неё
+        size_t firstRemoved = find_if(mem.rows.begin(), mem.rows.end(), [&](const Row& row) { return pred.matches(row[position]); }) - mem.rows.begin();
+        if (firstRemoved == mem.rows.size()) {
+            return false;
+        }
+        auto kept = stable_partition(mem.rows.begin() + firstRemoved, mem.rows.end(), [&](const Row& row) {
+            return !pred.matches(row[position]);
+        });
+        removed.assign(make_move_iterator(kept), make_move_iterator(mem.rows.end()));
+        mem.rows.erase(kept, mem.rows.end());
+        markDirty(mem, firstRemoved);
+        for (const Row& row : removed) {
+            feedAppend(table, ChangeType::Delete, row);
+        }
+    }
+    for (const Row& row : removed) {
+        statsOnDelete(table, row);
+    }
+    stats.rowsOut += removed.size();
+    return true;
+}
+
+void memScan(const Node* table, const function<void(const Row&)>& visit) {
+    shared_lock<shared_mutex> guard(table->mem->lock);
+    for (const Row& row : table->mem->rows) {
+        visit(row);
+    }
+}
+
+void snapshotTable(const Node* table) {
+    MemTable& mem = *table->mem;
+    lock_guard<mutex> snapshot(mem.snapshotLock);
+
+    // Копируются только строки с начала файла, где первое изменение; запись на диск идёт без блокировки
+    vector<Row> rows;
+    int lastPk;
+    size_t firstChunk;
+    {
+        shared_lock<shared_mutex> guard(mem.lock);
+        size_t dirtyFrom = mem.dirtyFrom.exchange(kClean);
+        if (dirtyFrom == kClean) {
+            return;
+        }
+        firstChunk = min(dirtyFrom, mem.rows.size()) / mem.chunkRows;
+        rows.assign(mem.rows.begin() + firstChunk * mem.chunkRows, mem.rows.end());
+        lastPk = mem.lastPk;
+    }
+
+    ifstream headerFile(table->header);
+    string header;
+    getline(headerFile, header);
+    headerFile.close();
+
+    int csvNumber = firstChunk;
+    for (size_t first = 0; first < rows.size(); first += mem.chunkRows) {
+        size_t last = min(rows.size(), first + mem.chunkRows);
+        if (!writeCsv(table, ++csvNumber, header, rows.begin() + first, rows.begin() + last)) {
+            markDirty(mem, (csvNumber - 1) * mem.chunkRows); // повторим в следующий раз
+            return;
+        }
+        if (last - first == mem.chunkRows) {
+            sealChunk(table, csvNumber); // заполненный файл сжимается, как у обычной таблицы
+        }
+    }
+    // Файлы, оставшиеся от прошлого снимка, где строк было больше
+    while (chunkExists(table, ++csvNumber)) {
+        if (!removeChunk(table, csvNumber)) {
+            markDirty(mem, (csvNumber - 1) * mem.chunkRows); // повторим в следующий раз
+            return;
+        }
+    }
+
+    ofstream filePk(table->pkFile);
+    filePk << lastPk;
+}
+
+void shutdownMemTables(const TableJson& json_table) {
+    for (Node* table = json_table.Tablehead; table; table = table->next) {
+        if (!isInMemory(table) || !table->mem->snapshotter.joinable()) {
+            continue;
+        }
+        {
+            lock_guard<mutex> guard(table->mem->stopLock);
+            table->mem->stopping = true;
+        }
+        table->mem->stopSignal.notify_all();
+        table->mem->snapshotter.join();
+        snapshotTable(table);
+    }
+}
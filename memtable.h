@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "Node.h"
+#include "planner.h"
+
+using namespace std;
+
+// Таблица в памяти ("in_memory": true в схеме). Строки хранятся одним массивом,
+// чтение идёт под разделяемой блокировкой, INSERT/DELETE - под исключительной,
+// без файла блокировки и файла последовательности. Фоновый поток раз в
+// snapshot_interval_ms выгружает изменённую таблицу в обычные N.csv файлы
+// (по tuples_limit строк), последний снимок делается в shutdownMemTables.
+// Переписываются только файлы, начиная с первого изменённого. Снимок - выгрузка
+// для чтения снаружи, а не восстановление: при запуске parser пересоздаёт
+// директорию схемы и таблица в памяти начинается пустой.
+const size_t kClean = SIZE_MAX; // изменений после снимка нет
+
+struct MemTable {
+    shared_mutex lock;
+    vector<Row> rows;           // первым в строке идёт <table>_pk
+    int lastPk = 0;
+    atomic<size_t> dirtyFrom{kClean}; // первая изменённая строка после последнего снимка
+
+    size_t chunkRows = 1;       // tuples_limit
+    chrono::milliseconds interval{1000};
+    mutex snapshotLock;         // снимки не пересекаются
+    mutex stopLock;
+    condition_variable stopSignal;
+    bool stopping = false;
+    thread snapshotter;
+};
+
+void initMemTable(Node* table, size_t chunkRows, chrono::milliseconds interval);
+bool isInMemory(const Node* table);
+void memInsert(const Node* table, Row& row); // row[0] заполняется новым первичным ключом
+// Удаление строк, где колонка position подходит под pred; false - ничего не удалено
+bool memDelete(const Node* table, int position, const Predicate& pred, OperatorStats& stats);
+void memScan(const Node* table, const function<void(const Row&)>& visit); // обход под разделяемой блокировкой
+void snapshotTable(const Node* table); // запись в N.csv, если были изменения
+void shutdownMemTables(const TableJson& json_table); // остановка потоков и последний снимок
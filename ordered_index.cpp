@@ -0,0 +1,100 @@
+#include "ordered_index.h"
+#include "chunk.h"
+#include "insert.h"
+
+namespace {
+    void addRow(TableIndexes& indexes, int csvNumber, const vector<string>& row) {
+        for (auto& [position, index] : indexes.columns) {
+            if (size_t(position) < row.size()) {
+                index.emplace(row[position], IndexEntry{row[0], csvNumber});
+            }
+        }
+    }
+
+    // Сбор индексов по всем файлам таблицы (вызывается под indexes.lock)
+    void loadIndexes(const Node* table, TableIndexes& indexes) {
+        for (int i : tableChunks(table)) {
+            rapidcsv::Document doc = readChunk(table, i);
+            for (size_t r = 0; r < doc.GetRowCount(); r++) {
+                addRow(indexes, i, doc.GetRow<string>(r));
+            }
+        }
+        indexes.loaded = true;
+    }
+}
+
+void initIndexes(Node* table, const vector<int>& positions) {
+    if (positions.empty()) {
+        return;
+    }
+    table->indexes = new TableIndexes;
+    for (int position : positions) {
+        table->indexes->columns[position];
+    }
+}
+
+bool hasIndex(const Node* table, int position) {
+    return table->indexes && table->indexes->columns.count(position);
+}
+
+set<int> indexLookup(const Node* table, int position, const Predicate& pred, size_t* matches) {
+    TableIndexes& indexes = *table->indexes;
+    lock_guard<mutex> guard(indexes.lock);
+    if (!indexes.loaded) {
+        loadIndexes(table, indexes);
+    }
+    set<int> chunks;
+    size_t count = 0;
+    forEachMatch(indexes.columns[position], pred, [&](const auto& entry) {
+        chunks.insert(entry.second.csvNumber);
+        count++;
+    });
+    if (matches) {
+        *matches = count;
+    }
+    return chunks;
+}
+
+size_t indexCount(const Node* table, int position, const Predicate& pred) {
+    TableIndexes& indexes = *table->indexes;
+    lock_guard<mutex> guard(indexes.lock);
+    if (!indexes.loaded) {
+        loadIndexes(table, indexes);
+    }
+    size_t count = 0;
+    forEachMatch(indexes.columns[position], pred, [&](const auto&) { count++; });
+    return count;
+}
+
+// Пока индекс не построен, изменения не учитываются: он соберётся из файлов при первом обращении
+void indexOnInsert(const Node* table, int csvNumber, const vector<string>& row) {
+    if (!table->indexes) {
+        return;
+    }
+    lock_guard<mutex> guard(table->indexes->lock);
+    if (table->indexes->loaded) {
+        addRow(*table->indexes, csvNumber, row);
+    }
+}
+
+void indexOnDelete(const Node* table, const vector<string>& row) {
+    if (!table->indexes) {
+        return;
+    }
+    lock_guard<mutex> guard(table->indexes->lock);
+    if (!table->indexes->loaded) {
+        return;
+    }
+    for (auto& [position, index] : table->indexes->columns) {
+        if (size_t(position) >= row.size()) {
+            continue;
+        }
+        auto range = index.equal_range(row[position]);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.pk == row[0]) {
+                index.erase(it);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "Node.h"
+#include "predicate.h"
+
+using namespace std;
+
+// Упорядоченный индекс колонки: значение -> (первичный ключ, номер файла).
+// Диапазонные и префиксные условия превращаются в обход участка дерева
+// и чтение только тех файлов, где есть подходящие строки.
+struct IndexEntry {
+    string pk;
+    int csvNumber;
+};
+
+struct TableIndexes {
+    mutex lock;
+    bool loaded = false; // индексы строятся по файлам при первом обращении
+    map<int, multimap<string, IndexEntry>> columns; // номер колонки -> индекс
+};
+
+void initIndexes(Node* table, const vector<int>& positions);
+bool hasIndex(const Node* table, int position);
+// Номера файлов, где есть строки, подходящие под условие; matches - число таких строк
+set<int> indexLookup(const Node* table, int position, const Predicate& pred, size_t* matches = nullptr);
+size_t indexCount(const Node* table, int position, const Predicate& pred); // число подходящих строк, без сбора файлов
+void indexOnInsert(const Node* table, int csvNumber, const vector<string>& row);
+void indexOnDelete(const Node* table, const vector<string>& row);
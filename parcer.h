@@ -1,5 +1,12 @@
 #pragma once
 #include "Node.h" // структура таблиц
+#include "planner.h" // статистика таблиц
+#include "bloom.h" // фильтры Блума
+#include "ordered_index.h" // индексы колонок
+#include "changefeed.h" // журнал изменений
+#include "memtable.h" // таблицы в памяти
+#include "partition.h" // разбиение по хешу колонки
+#include "chunk.h" // формат файлов таблиц
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -7,10 +14,13 @@
 #include "json.hpp" // json
 
 using namespace std;
-using json = nlohmann::json; 
+using json = nlohmann::json;
 namespace fs = filesystem;
 
 
 void DellDirectory(const fs::path& directoryPath); // удаление директории
-void CreatesDirFiles(const fs::path& SchemePath, const json& structure, TableJson& json_table); // создание полной директории и файлов
+fs::path TableSpacePath(const json& schema, const json& table, const TableJson& json_table); // корень tablespace для таблицы
+void CreatesDirFiles(const json& schema, const json& structure, TableJson& json_table); // создание полной директории и файлов
 void parser(TableJson& json_table); // парсинг схемы
+// выполнение одной команды: SELECT, INSERT, DELETE, EXPLAIN ANALYZE <команда>, SHOW METRICS
+bool executeCommand(const string& command, const TableJson& json_table);
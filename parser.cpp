@@ -1,4 +1,7 @@
 #include "parcer.h"
+#include "select.h"
+#include "profiler.h"
+#include <sstream>
 
 
 void DellDirectory(const fs::path& directoryPath) { // удаление директории
@@ -7,22 +10,48 @@ void DellDirectory(const fs::path& directoryPath) { // удаление дире
     }
 }
 
-void CreatesDirFiles(const fs::path& SchemePath, const json& structure, TableJson& json_table){
-    Node* Tablehead = nullptr;
+// Таблица может быть задана списком колонок или объектом {"columns": [...], "tablespace": "..."}.
+// Без tablespace таблица хранится в data_root.
+fs::path TableSpacePath(const json& schema, const json& table, const TableJson& json_table) {
+    if (!table.is_object() || !table.contains("tablespace")) {
+        return json_table.Root;
+    }
+    string space = table["tablespace"];
+    if (!schema.contains("tablespaces") || !schema["tablespaces"].contains(space)) {
+        cerr << "Tablespace " << space << " не описан, используется data_root.\n";
+        return json_table.Root;
+    }
+    return fs::path(schema["tablespaces"][space].get<string>());
+}
+
+void CreatesDirFiles(const json& schema, const json& structure, TableJson& json_table){
+    Node* TableHead = nullptr;
     Node* TableTail = nullptr;
 
     for(const auto& table : structure.items()){
-        fs::path tablePath = SchemePath / table.key();
-        if (!fs::create_directory(tablePath)) {
+        fs::path tablePath = TableSpacePath(schema, table.value(), json_table) / json_table.Name / table.key();
+        DellDirectory(tablePath); // в tablespace удаляем только свою таблицу
+        if (!fs::create_directories(tablePath)) {
                 cerr << "Не удалось создать директорию: " << tablePath << endl;
                 return;
             }
             cout << "Создана директория: " << tablePath << endl;
-        
-        ListNode* newTable = new Node{table.key(), nullptr, nullptr}; // создаём таблицу
-        fs::current_path(tablePath); // переходим в папку таблицы
-        string lock = table.key() + "_lock.txt"; // создаём файл блокировки
-        ofstream file(lock);
+
+        Node* newTable = new Node{table.key(), nullptr, nullptr}; // создаём таблицу
+        newTable->dir = tablePath; // запоминаем пути, чтобы не собирать их при каждом обращении
+        newTable->lockFile = tablePath / (table.key() + "_lock.txt");
+        newTable->pkFile = tablePath / (table.key() + "_pk_sequence.txt");
+        newTable->header = tablePath / "TableJS.csv";
+        if (table.value().is_object() && table.value().contains("compression")) {
+            string codec = table.value()["compression"];
+            if (codec == "lz4" || codec == "zstd") {
+                newTable->compression = codec;
+            } else if (codec != "none") {
+                cerr << "Неизвестный тип сжатия " << codec << ", таблица " << table.key() << " хранится без сжатия.\n";
+            }
+        }
+
+        ofstream file(newTable->lockFile); // создаём файл блокировки
         if (!file.is_open()) {
             cerr << "Не удалось открыть файл.\n";
         }
@@ -34,35 +63,29 @@ void CreatesDirFiles(const fs::path& SchemePath, const json& structure, TableJso
         }
         else {
             TableTail->next = newTable; // иначе добавляем новую таблицу в конец списка
-            TableTail = newTable; 
+            TableTail = newTable;
         }
-        
+
         string keyColumn = table.key() + "_pk"; // название специальной колонки
         ListNode* column_pk = new ListNode{keyColumn, nullptr}; // создаём список, где специальная колонка - первая
         newTable->column = column_pk; // присоединяем список колонок к таблице
 
-        fs::path csvFilePath = tablePath / "TableJS.csv"; // создаём csv файл
-        ofstream csvFile(csvFilePath);
+        ofstream csvFile(newTable->header); // создаём csv файл
         if (!csvFile.is_open()) {
-            cerr << "Не удалось создать файл: " << csvFilePath << endl;
+            cerr << "Не удалось создать файл: " << newTable->header << endl;
             return;
         }
-        
+
         csvFile << keyColumn << ",";
-        const auto& columns = table.value(); // запись колонок в файл, объект columns = названия
-        for (size_t i = 0; i < columns.size(); ++i) { 
+        const auto& columns = table.value().is_object() ? table.value()["columns"] : table.value(); // запись колонок в файл, объект columns = названия
+        for (size_t i = 0; i < columns.size(); ++i) {
             csvFile << columns[i].get<string>(); // записываем названия без кавычек
-            Node* newColumn = new Node{columns[i], nullptr}; // создаём новую колонку
-            if (newTable->column == nullptr) { // если в таблице ещё нет колонок
-                newTable->column = newColumn;
-            }
-            else {
-                ListNode* lastColumn = newTable->column;
-                while (lastColumn->next != nullptr) { // ищем последнюю колонку
-                    lastColumn = lastColumn->next;
-                }
-                lastColumn->next = newColumn; // добавляем новую колонку в конец
+            ListNode* newColumn = new ListNode{columns[i].get<string>(), nullptr}; // создаём новую колонку
+            ListNode* lastColumn = newTable->column;
+            while (lastColumn->next != nullptr) { // ищем последнюю колонку
+                lastColumn = lastColumn->next;
             }
+            lastColumn->next = newColumn; // добавляем новую колонку в конец
             if (i < columns.size() - 1) { // для последнего значения не нужна запятая
                 csvFile << ",";
             }
@@ -70,17 +93,58 @@ void CreatesDirFiles(const fs::path& SchemePath, const json& structure, TableJso
 
         csvFile << endl;
         csvFile.close();
-        cout << "Создан файл: " << csvFilePath << endl;
+        initStats(newTable); // статистика по колонкам для планировщика
+        initChunkFormats(newTable);
+        initBlooms(newTable, json_table.TableSize); // фильтр на файл рассчитан на tuples_limit строк
 
-        string pk = keyColumn + "_sequence.txt"; // создаём файл для хранения уникального первичного ключа
-        ofstream filePk(pk);
+        bool inMemory = table.value().is_object() && table.value().value("in_memory", false);
+        vector<int> indexed; // колонки с упорядоченным индексом: "indexes": ["col", ...]
+        if (inMemory && table.value().contains("indexes")) {
+            cerr << "Таблица " << table.key() << " хранится в памяти, индексы не строятся.\n";
+        } else if (table.value().is_object() && table.value().contains("indexes")) {
+            for (const auto& column : table.value()["indexes"]) {
+                int position = columnPosition(newTable, column.get<string>());
+                if (position < 0) {
+                    cerr << "Индекс по несуществующей колонке " << column.get<string>() << " в таблице " << table.key() << ".\n";
+                    continue;
+                }
+                indexed.push_back(position);
+            }
+        }
+        initIndexes(newTable, indexed);
+
+        // "partition_by": "col" - строки раскладываются по "partitions" поддиректориям p0, p1, ... по хешу колонки
+        if (table.value().is_object() && table.value().contains("partition_by")) {
+            int position = columnPosition(newTable, table.value()["partition_by"].get<string>());
+            int partitions = table.value().value("partitions", 4);
+            if (position < 0) {
+                cerr << "Разбиение по несуществующей колонке " << table.value()["partition_by"].get<string>() << " в таблице " << table.key() << ".\n";
+            } else if (inMemory) {
+                cerr << "Таблица " << table.key() << " хранится в памяти, разбиение не используется.\n";
+            } else if (partitions < 1 || partitions > 1000) {
+                cerr << "Некорректное число партиций " << partitions << " в таблице " << table.key() << ".\n";
+            } else {
+                newTable->partitionColumn = position;
+                newTable->partitions = partitions;
+                for (int p = 0; p < partitions; p++) {
+                    fs::create_directories(partitionDir(newTable, p));
+                }
+            }
+        }
+        initChangeFeed(newTable);
+        if (inMemory) { // строки в памяти, в N.csv раз в snapshot_interval_ms пишется снимок
+            initMemTable(newTable, json_table.TableSize, chrono::milliseconds(table.value().value("snapshot_interval_ms", 1000)));
+        }
+        cout << "Создан файл: " << newTable->header << endl;
+
+        ofstream filePk(newTable->pkFile); // создаём файл для хранения уникального первичного ключа
         if (!filePk.is_open()) {
             cerr << "Не удалось открыть файл.\n";
         }
         filePk << "0";
         filePk.close();
     }
-    json_table.tablehead = tableHead;
+    json_table.Tablehead = TableHead;
 }
 
 
@@ -89,6 +153,7 @@ void parser(TableJson& json_table){
     ifstream file(fileName);
     if(!file.is_open()){
         cout << "Не удалось открыть файл";
+        return;
     }
 
     string json_include; //содержимое
@@ -99,19 +164,48 @@ void parser(TableJson& json_table){
     file.close();
 
     json parser_Json;
-    parser_Json = json::parse(parser_Json);
+    parser_Json = json::parse(json_include);
 
-    json_table.schemeName = parser_Json["name"]; // извлекаем имя схемы
-    fs::path schemePath = fs::current_path() / json_table.schemeName; // формируем путь к директории
-    removeDirectory(schemePath); // удаляем, чтобы заново создать директорию
-    if (!fs::create_directory(schemePath)) { // проверка
+    json_table.Name = parser_Json["name"]; // извлекаем имя схемы
+    // корень данных: "data_root" из схемы, иначе текущая директория
+    json_table.Root = parser_Json.contains("data_root") ? fs::path(parser_Json["data_root"].get<string>()) : fs::current_path();
+    fs::path schemePath = json_table.Root / json_table.Name; // формируем путь к директории
+    DellDirectory(schemePath); // удаляем, чтобы заново создать директорию
+    if (!fs::create_directories(schemePath)) { // проверка
         cerr << "Не удалось создать директорию: " << schemePath << endl;
         return;
     }
     cout << "Создана директория: " << schemePath << endl;
+    json_table.TableSize = parser_Json["tuples_limit"]; // вытаскиваем ограничения по строкам
     if (parser_Json.contains("structure")) { // наполнение директории
-        createDirectoriesAndFiles(schemePath, parser_Json["structure"], json_table);
+        CreatesDirFiles(parser_Json, parser_Json["structure"], json_table);
     }
-    json_table.tableSize = parser_Json["tuples_limit"]; // вытаскиваем ограничения по строкам
 }
 
+
+bool executeCommand(const string& command, const TableJson& json_table){
+    istringstream iss(command);
+    string slovo;
+    iss >> slovo;
+    if (slovo == "SELECT") {
+        return select(command, json_table);
+    }
+    if (slovo == "INSERT") {
+        return insert(command, json_table);
+    }
+    if (slovo == "DELETE") {
+        return delet(command, json_table);
+    }
+    if (slovo == "EXPLAIN") {
+        return explainAnalyze(command, json_table);
+    }
+    if (slovo == "SHOW") {
+        iss >> slovo;
+        if (slovo == "METRICS") { // накопленные метрики запросов
+            dumpMetrics(cout);
+            return true;
+        }
+    }
+    cerr << "Неизвестная команда: " << command << endl;
+    return false;
+}
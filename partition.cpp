@@ -0,0 +1,65 @@
+#include "partition.h"
+#include "insert.h"
+#include "hash.h"
+#include <algorithm>
+
+fs::path partitionDir(const Node* table, int partition) {
+    if (table->partitionColumn < 0) {
+        return table->dir;
+    }
+    return table->dir / ("p" + to_string(partition));
+}
+
+int partitionOf(const Node* table, const string& value) {
+    if (table->partitionColumn < 0) {
+        return 0;
+    }
+    return stableHash(value) % table->partitions;
+}
+
+int rowPartition(const Node* table, const vector<string>& row) {
+    size_t position = table->partitionColumn;
+    return partitionOf(table, position < row.size() ? row[position] : "");
+}
+
+vector<int> partitionChunks(const Node* table, int partition) {
+    vector<int> chunks;
+    for (int i = 1, cntCsv = findCsvFileCount(table, partition); i <= cntCsv; i++) {
+        chunks.push_back(partition * kPartitionChunks + i);
+    }
+    return chunks;
+}
+
+vector<int> tableChunks(const Node* table) {
+    vector<int> chunks;
+    for (int p = 0; p < table->partitions; p++) {
+        vector<int> part = partitionChunks(table, p);
+        chunks.insert(chunks.end(), part.begin(), part.end());
+    }
+    return chunks;
+}
+
+vector<int> partitionsFor(const Node* table, int position, const Predicate& pred) {
+    vector<int> partitions;
+    if (position == table->partitionColumn && pred.exactValues()) {
+        for (const string& value : pred.values) {
+            partitions.push_back(partitionOf(table, value));
+        }
+        sort(partitions.begin(), partitions.end());
+        partitions.erase(unique(partitions.begin(), partitions.end()), partitions.end());
+        return partitions;
+    }
+    for (int p = 0; p < table->partitions; p++) {
+        partitions.push_back(p);
+    }
+    return partitions;
+}
+
+vector<int> chunksFor(const Node* table, int position, const Predicate& pred) {
+    vector<int> chunks;
+    for (int p : partitionsFor(table, position, pred)) {
+        vector<int> part = partitionChunks(table, p);
+        chunks.insert(chunks.end(), part.begin(), part.end());
+    }
+    return chunks;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Node.h"
+#include "predicate.h"
+
+using namespace std;
+namespace fs = filesystem;
+
+// Горизонтальное разбиение таблицы по хешу колонки ("partition_by" в схеме).
+// Партиция p хранится в поддиректории p<номер> со своими N.csv, а номер файла
+// кодирует партицию: csvNumber = p * kPartitionChunks + номер файла в партиции.
+// Поэтому chunkPath, фильтры Блума и индексы работают с партициями без изменений.
+// Таблица без разбиения - одна партиция 0 в директории самой таблицы.
+// В партиции не больше kPartitionChunks - 1 файлов: дальше INSERT отказывает.
+const int kPartitionChunks = 100000;
+
+fs::path partitionDir(const Node* table, int partition);
+int partitionOf(const Node* table, const string& value); // партиция строки со значением ключа value
+int rowPartition(const Node* table, const vector<string>& row);
+vector<int> partitionChunks(const Node* table, int partition); // номера файлов партиции
+vector<int> tableChunks(const Node* table); // файлы всех партиций
+// Партиции, где могут быть строки под условием pred на колонку position:
+// для = и IN по ключу разбиения - только партиции этих значений, иначе все
+vector<int> partitionsFor(const Node* table, int position, const Predicate& pred);
+vector<int> chunksFor(const Node* table, int position, const Predicate& pred);
@@ -0,0 +1,594 @@
+#include "planner.h"
+#include "insert.h"
+#include "bloom.h"
+#include "ordered_index.h"
+#include "memtable.h"
+#include "partition.h"
+#include "hash.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+    void addRow(TableStats& stats, const Row& row) {
+        stats.rows++;
+        for (size_t c = 0; c < row.size() && c < stats.columns.size(); c++) {
+            ColumnStats& column = stats.columns[c];
+            if (stats.rows > 1 && row[c] < column.last) {
+                column.ascending = false;
+            }
+            column.last = row[c];
+            if (column.seen == 0 || row[c] < column.min) {
+                column.min = row[c];
+            }
+            if (column.seen == 0 || column.max < row[c]) {
+                column.max = row[c];
+            }
+
+            // Reservoir sampling: каждое значение остаётся в выборке с вероятностью kStatsSample / seen
+            column.seen++;
+            if (column.sample.size() < kStatsSample) {
+                column.sample.push_back(row[c]);
+            } else {
+                size_t slot = stats.random() % column.seen;
+                if (slot < kStatsSample) {
+                    column.sample[slot] = row[c];
+                }
+            }
+
+            uint64_t hash = stableHash(row[c]);
+            if (column.minHashes.size() < kNdvSketch || hash < *column.minHashes.rbegin()) {
+                column.minHashes.insert(hash);
+                if (column.minHashes.size() > kNdvSketch) {
+                    column.minHashes.erase(prev(column.minHashes.end()));
+                }
+            }
+        }
+    }
+
+    // Удалённое значение убирается из выборки; оценка числа различных и границы не уменьшаются
+    void removeRow(TableStats& stats, const Row& row) {
+        if (stats.rows > 0) {
+            stats.rows--;
+        }
+        for (size_t c = 0; c < row.size() && c < stats.columns.size(); c++) {
+            ColumnStats& column = stats.columns[c];
+            auto it = find(column.sample.begin(), column.sample.end(), row[c]);
+            if (it != column.sample.end()) {
+                *it = move(column.sample.back());
+                column.sample.pop_back();
+            }
+            if (column.seen > 0) {
+                column.seen--;
+            }
+        }
+    }
+
+    // Число различных значений по k минимальным хешам: (k - 1) / доля диапазона хешей до k-го
+    double distinctValues(const ColumnStats& column) {
+        if (column.minHashes.size() < kNdvSketch) {
+            return column.minHashes.size();
+        }
+        double kth = double(*column.minHashes.rbegin()) / 18446744073709551616.0;
+        return kth > 0 ? (kNdvSketch - 1) / kth : kNdvSketch;
+    }
+
+    // Оценка числа строк под условием: вне [min, max] - ноль, иначе доля подходящих в выборке
+    double estimateMatches(const TableStats& stats, const ColumnStats& column, const Predicate& pred) {
+        if (stats.rows == 0 || column.sample.empty() || !pred.mayOverlap(column.min, column.max)) {
+            return 0;
+        }
+        size_t hits = count_if(column.sample.begin(), column.sample.end(), [&](const string& value) { return pred.matches(value); });
+        double fraction = double(hits) / column.sample.size();
+        if (hits == 0) {
+            // Редкие значения в выборку могут не попасть: для = / IN считаем по числу различных
+            fraction = pred.exactValues() ? pred.values.size() / max(distinctValues(column), 1.0) : 1.0 / (column.sample.size() + 1);
+        }
+        return min(fraction, 1.0) * stats.rows;
+    }
+
+    // Сбор статистики по всем csv файлам таблицы (вызывается под stats.lock)
+    void loadStats(const Node* table, TableStats& stats) {
+        if (isInMemory(table)) {
+            memScan(table, [&](const Row& row) { addRow(stats, row); });
+            stats.loaded = true;
+            return;
+        }
+        for (int i : tableChunks(table)) {
+            rapidcsv::Document doc = readChunk(table, i);
+            for (size_t r = 0; r < doc.GetRowCount(); r++) {
+                addRow(stats, doc.GetRow<string>(r));
+            }
+        }
+        stats.loaded = true;
+    }
+
+    double sortCost(double rows, bool sorted) {
+        return sorted ? 0 : rows * log2(rows + 1);
+    }
+
+    // Условие, привязанное к позициям колонок в паре строк (left, right)
+    struct BoundCondition {
+        bool left1; int pos1;
+        bool join;  bool left2; int pos2;
+        Predicate pred;
+
+        bool holds(const Row& left, const Row& right) const {
+            const string& a = (left1 ? left : right)[pos1];
+            return join ? a == (left2 ? left : right)[pos2] : pred.matches(a);
+        }
+    };
+
+    // partition >= 0 - читается только эта партиция (часть соединения по партициям)
+    vector<Row> scanTable(const ScanPlan& scan, OperatorStats& stats, int partition = -1) {
+        ScopedTimer timer(stats.time);
+        vector<Row> rows;
+        size_t width = scan.table->stats->columns.size();
+        auto matches = [&](const Row& row) {
+            for (const Filter& filter : scan.filters) { // первым проверяется самый селективный
+                if (!filter.pred.matches(row[filter.position])) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (isInMemory(scan.table)) {
+            memScan(scan.table, [&](const Row& row) {
+                stats.rowsIn++;
+                if (matches(row)) {
+                    rows.push_back(row);
+                }
+            });
+            stats.rowsOut += rows.size();
+            return rows;
+        }
+        // Из сжатых файлов читаются только блоки, где по min/max могут быть значения фильтров
+        BlockFilter need = [&](const ChunkBlock& block) {
+            for (const Filter& filter : scan.filters) {
+                if (!filter.pred.mayOverlap(block.min[filter.position], block.max[filter.position])) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        // С индексом читаются только файлы, где есть подходящие строки, по ключу разбиения - только нужные партиции
+        vector<int> chunks;
+        if (scan.indexFilter >= 0) {
+            const Filter& key = scan.filters[scan.indexFilter];
+            set<int> found = indexLookup(scan.table, key.position, key.pred);
+            chunks.assign(found.begin(), found.end());
+        } else if (scan.partitionFilter >= 0) {
+            const Filter& key = scan.filters[scan.partitionFilter];
+            chunks = chunksFor(scan.table, key.position, key.pred);
+        } else {
+            chunks = partition >= 0 ? partitionChunks(scan.table, partition) : tableChunks(scan.table);
+        }
+        if (partition >= 0) {
+            chunks.erase(remove_if(chunks.begin(), chunks.end(), [&](int i) { return i / kPartitionChunks != partition; }), chunks.end());
+        }
+        for (int i : chunks) {
+            bool skip = false;
+            for (const Filter& filter : scan.filters) {
+                skip = skip || !chunkMayMatch(scan.table, i, filter.position, filter.pred);
+            }
+            if (skip) {
+                stats.chunksSkipped++; // по фильтру Блума значения в файле точно нет
+                continue;
+            }
+            rapidcsv::Document doc = readChunk(scan.table, i, &stats, need);
+            size_t cntRow = doc.GetRowCount();
+            stats.rowsIn += cntRow;
+            for (size_t r = 0; r < cntRow; r++) {
+                Row row = doc.GetRow<string>(r);
+                row.resize(width); // недостающие значения считаются пустыми
+                if (matches(row)) {
+                    rows.push_back(move(row));
+                }
+            }
+        }
+        stats.rowsOut += rows.size();
+        return rows;
+    }
+
+    // Вид чтения без условий и оценок - ключ метрик
+    string scanKind(const ScanPlan& scan) {
+        return (scan.indexFilter >= 0 ? "IndexScan " : "Scan ") + scan.table->table;
+    }
+
+    string scanName(const ScanPlan& scan) {
+        ostringstream out;
+        out << scanKind(scan);
+        for (const Filter& filter : scan.filters) {
+            out << " [" << filter.column << " " << filter.pred.describe() << "]";
+        }
+        if (scan.partitionFilter >= 0) {
+            const Filter& key = scan.filters[scan.partitionFilter];
+            out << " partitions=" << partitionsFor(scan.table, key.position, key.pred).size() << "/" << scan.table->partitions;
+        }
+        out << " est=" << scan.estimate;
+        return out.str();
+    }
+
+    string joinKind(const Plan& plan) {
+        string method = plan.method == JoinMethod::HashJoin ? "HashJoin"
+                      : plan.method == JoinMethod::MergeJoin ? "MergeJoin" : "NestedLoop";
+        return plan.partitionWise ? "PartitionWise " + method : method;
+    }
+
+    string joinName(const Plan& plan) {
+        ostringstream out;
+        if (plan.partitionWise) {
+            out << "PartitionWise(" << plan.left.table->partitions << ") ";
+        }
+        switch (plan.method) {
+            case JoinMethod::HashJoin:
+                out << "HashJoin build=" << (plan.buildLeft ? plan.left : plan.right).table->table
+                    << " probe=" << (plan.buildLeft ? plan.right : plan.left).table->table;
+                break;
+            case JoinMethod::MergeJoin:
+                out << "MergeJoin";
+                break;
+            default:
+                out << (plan.anyOf ? "NestedLoop (OR)" : "NestedLoop");
+        }
+        out << " cost=" << plan.cost;
+        return out.str();
+    }
+}
+
+void initStats(Node* table) {
+    table->stats = new TableStats;
+    size_t count = 0;
+    for (ListNode* column = table->column; column; column = column->next) {
+        count++;
+    }
+    table->stats->columns.resize(count);
+}
+
+int columnPosition(const Node* table, const string& column) {
+    int position = 0;
+    for (ListNode* current = table->column; current; current = current->next, position++) {
+        if (current->column_name == column) {
+            return position;
+        }
+    }
+    return -1;
+}
+
+TableStats& tableStats(const Node* table) {
+    TableStats& stats = *table->stats;
+    lock_guard<mutex> guard(stats.lock);
+    if (!stats.loaded) {
+        loadStats(table, stats);
+    }
+    return stats;
+}
+
+// Пока статистика не собрана, изменения не учитываются: она соберётся из файлов при первом обращении
+void statsOnInsert(const Node* table, const Row& row) {
+    lock_guard<mutex> guard(table->stats->lock);
+    if (table->stats->loaded) {
+        addRow(*table->stats, row);
+    }
+}
+
+void statsOnDelete(const Node* table, const Row& row) {
+    lock_guard<mutex> guard(table->stats->lock);
+    if (table->stats->loaded) {
+        removeRow(*table->stats, row);
+    }
+}
+
+bool buildPlan(const TableJson& json_table, const string& table1, const string& column1, const string& table2, const string& column2,
+               const vector<Condition>& conditions, bool anyOf, Plan& plan) {
+    plan = Plan{};
+    plan.anyOf = anyOf;
+    plan.left.table = FindTable(json_table.Tablehead, table1);
+    plan.right.table = FindTable(json_table.Tablehead, table2);
+    if (!plan.left.table || !plan.right.table) {
+        cerr << "Некорректная команда: таблица не найдена.\n";
+        return false;
+    }
+    plan.left.outColumn = column1;
+    plan.right.outColumn = column2;
+    plan.left.outPosition = columnPosition(plan.left.table, column1);
+    plan.right.outPosition = columnPosition(plan.right.table, column2);
+    if (plan.left.outPosition < 0 || plan.right.outPosition < 0) {
+        cerr << "Некорректная команда: колонка не найдена.\n";
+        return false;
+    }
+
+    for (const Condition& cond : conditions) {
+        bool known = (cond.table1 == table1 || cond.table1 == table2) && columnPosition(FindTable(json_table.Tablehead, cond.table1), cond.column1) >= 0;
+        if (cond.isJoin()) {
+            known = known && (cond.table2 == table1 || cond.table2 == table2) && columnPosition(FindTable(json_table.Tablehead, cond.table2), cond.column2) >= 0;
+        }
+        if (!known) {
+            cerr << "Некорректная команда: условие ссылается на неизвестную колонку.\n";
+            return false;
+        }
+    }
+
+    TableStats& leftStats = tableStats(plan.left.table);
+    TableStats& rightStats = tableStats(plan.right.table);
+
+    if (anyOf) {
+        // OR нельзя разложить на фильтры и ключ соединения - проверяем каждую пару строк
+        plan.residual = conditions;
+        {
+            lock_guard<mutex> guard(leftStats.lock);
+            plan.left.estimate = leftStats.rows;
+        }
+        {
+            lock_guard<mutex> guard(rightStats.lock);
+            plan.right.estimate = rightStats.rows;
+        }
+        plan.cost = plan.left.estimate * plan.right.estimate;
+        return true;
+    }
+
+    // AND: сравнения со строкой становятся фильтрами при чтении, первое равенство колонок - ключом соединения
+    for (const Condition& cond : conditions) {
+        if (!cond.isJoin()) {
+            ScanPlan& scan = cond.table1 == table1 ? plan.left : plan.right;
+            scan.filters.push_back(Filter{columnPosition(scan.table, cond.column1), cond.column1, cond.pred, 0});
+        } else if (plan.leftKey < 0 && cond.table1 != cond.table2) {
+            bool straight = cond.table1 == table1;
+            plan.leftKey = columnPosition(plan.left.table, straight ? cond.column1 : cond.column2);
+            plan.rightKey = columnPosition(plan.right.table, straight ? cond.column2 : cond.column1);
+        } else {
+            plan.residual.push_back(cond);
+        }
+    }
+
+    // Оценка размера каждой стороны по выборке значений
+    bool sortedLeft = false, sortedRight = false;
+    for (auto [scan, stats, sorted] : {make_tuple(&plan.left, &leftStats, &sortedLeft), make_tuple(&plan.right, &rightStats, &sortedRight)}) {
+        lock_guard<mutex> guard(stats->lock);
+        double estimate = stats->rows;
+        for (Filter& filter : scan->filters) {
+            filter.matches = estimateMatches(*stats, stats->columns[filter.position], filter.pred);
+            estimate *= stats->rows ? filter.matches / stats->rows : 0;
+        }
+        sort(scan->filters.begin(), scan->filters.end(), [](const Filter& a, const Filter& b) { return a.matches < b.matches; });
+        scan->estimate = estimate;
+
+        // По ключу разбиения с = / IN читается доля партиций
+        double scanCost = stats->rows;
+        for (size_t f = 0; f < scan->filters.size(); f++) {
+            const Filter& filter = scan->filters[f];
+            if (filter.position != scan->table->partitionColumn || !filter.pred.exactValues()) {
+                continue;
+            }
+            double partCost = stats->rows * partitionsFor(scan->table, filter.position, filter.pred).size() / scan->table->partitions;
+            if (partCost < scanCost) {
+                scan->partitionFilter = f;
+                scanCost = partCost;
+            }
+        }
+
+        // Индекс выгоднее полного чтения, если подходящие строки лежат в меньшем числе файлов.
+        // Число строк берём из индекса, число файлов оцениваем: при вставке по возрастанию
+        // строки идут подряд, иначе разбросаны по файлам случайно.
+        double chunkRows = max(1, json_table.TableSize);
+        double totalChunks = ceil(stats->rows / chunkRows);
+        for (size_t f = 0; f < scan->filters.size(); f++) {
+            const Filter& filter = scan->filters[f];
+            if (!hasIndex(scan->table, filter.position)) {
+                continue;
+            }
+            double found = indexCount(scan->table, filter.position, filter.pred);
+            double chunks = stats->columns[filter.position].ascending
+                ? min(totalChunks, ceil(found / chunkRows) + 1)
+                : totalChunks * (1 - pow(1 - 1 / max(totalChunks, 1.0), found));
+            double indexCost = log2(stats->rows + 1) + found + chunks * chunkRows;
+            if (indexCost < scanCost) {
+                scan->indexFilter = f;
+                scanCost = indexCost;
+            }
+        }
+        int key = scan == &plan.left ? plan.leftKey : plan.rightKey;
+        *sorted = key >= 0 && stats->columns[key].ascending;
+    }
+
+    double nl = plan.left.estimate, nr = plan.right.estimate;
+    plan.method = JoinMethod::NestedLoop;
+    plan.cost = nl * nr;
+    if (plan.leftKey >= 0) {
+        double hashCost = 2 * min(nl, nr) + max(nl, nr);
+        double mergeCost = sortCost(nl, sortedLeft) + sortCost(nr, sortedRight) + nl + nr;
+        if (hashCost <= plan.cost) {
+            plan.method = JoinMethod::HashJoin;
+            plan.cost = hashCost;
+            plan.buildLeft = nl < nr;
+        }
+        if (mergeCost < plan.cost) {
+            plan.method = JoinMethod::MergeJoin;
+            plan.cost = mergeCost;
+        }
+        // Совпадающие ключи лежат в партициях с одинаковым номером: пары партиций соединяются независимо
+        const Node* l = plan.left.table;
+        const Node* r = plan.right.table;
+        plan.partitionWise = l->partitions > 1 && l->partitions == r->partitions
+            && l->partitionColumn == plan.leftKey && r->partitionColumn == plan.rightKey;
+    }
+    return true;
+}
+
+namespace {
+    vector<BoundCondition> bindResidual(const Plan& plan) {
+        vector<BoundCondition> residual;
+        for (const Condition& cond : plan.residual) {
+            const Node* first = cond.table1 == plan.left.table->table ? plan.left.table : plan.right.table;
+            BoundCondition bound{first == plan.left.table, columnPosition(first, cond.column1), cond.isJoin(), false, -1, cond.pred};
+            if (cond.isJoin()) {
+                const Node* second = cond.table2 == plan.left.table->table ? plan.left.table : plan.right.table;
+                bound.left2 = second == plan.left.table;
+                bound.pos2 = columnPosition(second, cond.column2);
+            }
+            residual.push_back(bound);
+        }
+        return residual;
+    }
+
+    // Соединение прочитанных строк выбранным способом, пары значений пишутся в out
+    void joinRows(const Plan& plan, const vector<Row>& left, const vector<Row>& right,
+                  const vector<BoundCondition>& residual, OperatorStats& stats, ostream& out) {
+        const string& column1 = plan.left.outColumn;
+        const string& column2 = plan.right.outColumn;
+        auto emit = [&](const Row& l, const Row& r) {
+            if (!residual.empty()) {
+                bool any = false, all = true;
+                for (const BoundCondition& cond : residual) {
+                    bool holds = cond.holds(l, r);
+                    any = any || holds;
+                    all = all && holds;
+                }
+                if (plan.anyOf ? !any : !all) {
+                    return;
+                }
+            }
+            stats.rowsOut++;
+            if (plan.leftKey >= 0) { // пара прошла сравнение колонок двух таблиц
+                out << "Сравнение таблиц" << endl;
+            }
+            out << "Таблица1 (" << column1 << "): " << l[plan.left.outPosition] << " | Таблица2 (" << column2 << "): " << r[plan.right.outPosition] << endl;
+        };
+
+        if (plan.method == JoinMethod::HashJoin) {
+            const vector<Row>& build = plan.buildLeft ? left : right;
+            const vector<Row>& probe = plan.buildLeft ? right : left;
+            int buildKey = plan.buildLeft ? plan.leftKey : plan.rightKey;
+            int probeKey = plan.buildLeft ? plan.rightKey : plan.leftKey;
+            unordered_map<string, vector<size_t>> hash;
+            for (size_t i = 0; i < build.size(); i++) {
+                hash[build[i][buildKey]].push_back(i);
+            }
+            for (const Row& row : probe) {
+                auto it = hash.find(row[probeKey]);
+                if (it == hash.end()) {
+                    continue;
+                }
+                for (size_t i : it->second) {
+                    plan.buildLeft ? emit(build[i], row) : emit(row, build[i]);
+                }
+            }
+        } else if (plan.method == JoinMethod::MergeJoin) {
+            // Строки уже отсортированы по ключу, если вставлялись по возрастанию; иначе сортируем индексы
+            auto order = [](const vector<Row>& rows, int key) {
+                vector<size_t> idx(rows.size());
+                iota(idx.begin(), idx.end(), 0);
+                if (!is_sorted(idx.begin(), idx.end(), [&](size_t a, size_t b) { return rows[a][key] < rows[b][key]; })) {
+                    stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return rows[a][key] < rows[b][key]; });
+                }
+                return idx;
+            };
+            vector<size_t> li = order(left, plan.leftKey), ri = order(right, plan.rightKey);
+            size_t i = 0, j = 0;
+            while (i < li.size() && j < ri.size()) {
+                const string& a = left[li[i]][plan.leftKey];
+                const string& b = right[ri[j]][plan.rightKey];
+                if (a < b) {
+                    i++;
+                } else if (b < a) {
+                    j++;
+                } else {
+                    size_t iEnd = i, jEnd = j;
+                    while (iEnd < li.size() && left[li[iEnd]][plan.leftKey] == a) iEnd++;
+                    while (jEnd < ri.size() && right[ri[jEnd]][plan.rightKey] == a) jEnd++;
+                    for (size_t x = i; x < iEnd; x++) {
+                        for (size_t y = j; y < jEnd; y++) {
+                            emit(left[li[x]], right[ri[y]]);
+                        }
+                    }
+                    i = iEnd;
+                    j = jEnd;
+                }
+            }
+        } else {
+            for (const Row& l : left) {
+                for (const Row& r : right) {
+                    if (plan.leftKey < 0 || l[plan.leftKey] == r[plan.rightKey]) {
+                        emit(l, r);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void executePlan(const Plan& plan) {
+    vector<BoundCondition> residual = bindResidual(plan);
+
+    if (plan.partitionWise) {
+        OperatorStats& leftStats = profileOperator(scanName(plan.left), scanKind(plan.left));
+        OperatorStats& rightStats = profileOperator(scanName(plan.right), scanKind(plan.right));
+        OperatorStats& stats = profileOperator(joinName(plan), joinKind(plan));
+        ScopedTimer timer(stats.time);
+
+        // Каждая пара партиций читается и соединяется в своём потоке; время чтения - сумма по потокам
+        struct PartResult {
+            OperatorStats left, right, join;
+            ostringstream out;
+        };
+        int partitions = plan.left.table->partitions;
+        vector<PartResult> parts(partitions);
+        atomic<int> next{0};
+        // Исключение из потока передаётся в вызывающий поток, остальные потоки перестают брать партиции
+        exception_ptr failure;
+        mutex failureLock;
+        auto worker = [&] {
+            try {
+                for (int p = next++; p < partitions; p = next++) {
+                    PartResult& part = parts[p];
+                    vector<Row> left = scanTable(plan.left, part.left, p);
+                    if (left.empty()) {
+                        continue; // пара без строк слева ничего не даст
+                    }
+                    vector<Row> right = scanTable(plan.right, part.right, p);
+                    part.join.rowsIn = left.size() + right.size();
+                    joinRows(plan, left, right, residual, part.join, part.out);
+                }
+            } catch (...) {
+                lock_guard<mutex> guard(failureLock);
+                if (!failure) {
+                    failure = current_exception();
+                }
+                next = partitions;
+            }
+        };
+        vector<thread> workers;
+        int threads = min<int>(partitions, max(1u, thread::hardware_concurrency()));
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back(worker);
+        }
+        for (thread& t : workers) {
+            t.join();
+        }
+        if (failure) {
+            rethrow_exception(failure);
+        }
+        for (PartResult& part : parts) {
+            mergeStats(leftStats, part.left);
+            mergeStats(rightStats, part.right);
+            mergeStats(stats, part.join);
+            cout << part.out.str();
+        }
+        return;
+    }
+
+    OperatorStats& leftStats = profileOperator(scanName(plan.left), scanKind(plan.left));
+    vector<Row> left = scanTable(plan.left, leftStats);
+    OperatorStats& rightStats = profileOperator(scanName(plan.right), scanKind(plan.right));
+    vector<Row> right = scanTable(plan.right, rightStats);
+
+    OperatorStats& stats = profileOperator(joinName(plan), joinKind(plan));
+    ScopedTimer timer(stats.time);
+    stats.rowsIn = left.size() + right.size();
+    joinRows(plan, left, right, residual, stats, cout);
+}
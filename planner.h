@@ -0,0 +1,90 @@
+#pragma once
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "Node.h"
+#include "profiler.h"
+#include "predicate.h"
+
+using namespace std;
+
+using Row = vector<string>; // строка таблицы в порядке колонок из схемы
+
+const size_t kStatsSample = 1024; // значений в выборке колонки
+const size_t kNdvSketch = 256;    // минимальных хешей для оценки числа различных
+
+// Статистика одной колонки, поддерживается при INSERT/DELETE. Размер не
+// зависит от таблицы: выборка значений и k минимальных хешей (KMV).
+// Статистика только для оценки стоимости: обновляется вне блокировки записи
+// и может отставать, поэтому чтение таблицы по ней не пропускается.
+struct ColumnStats {
+    vector<string> sample;      // равномерная выборка значений (reservoir sampling)
+    size_t seen = 0;            // сколько значений прошло через выборку
+    set<uint64_t> minHashes;    // kNdvSketch наименьших хешей значений
+    string min, max;            // границы значений (при удалении не сужаются)
+    bool ascending = true;      // значения вставлялись по неубыванию (порядок хранения отсортирован)
+    string last;                // последнее вставленное значение
+};
+
+// Статистика таблицы
+struct TableStats {
+    mutex lock;
+    bool loaded = false; // при первом обращении статистика собирается по csv файлам
+    size_t rows = 0;
+    vector<ColumnStats> columns; // в порядке колонок таблицы
+    minstd_rand random;          // выбор места в выборке
+};
+
+// Условие WHERE: table1.column1 = table2.column2 либо table1.column1 <оператор> 'value'
+struct Condition {
+    string table1, column1;
+    string table2, column2; // пусто, если сравнение со строкой
+    Predicate pred;
+    bool isJoin() const { return !table2.empty(); }
+};
+
+// Фильтр по значению, проверяемый при чтении таблицы
+struct Filter {
+    int position;   // номер колонки
+    string column;
+    Predicate pred;
+    double matches; // оценка числа подходящих строк по статистике
+};
+
+// Чтение одной таблицы
+struct ScanPlan {
+    const Node* table = nullptr;
+    string outColumn;       // колонка из SELECT
+    int outPosition = -1;
+    vector<Filter> filters; // самый селективный фильтр проверяется первым
+    int indexFilter = -1;   // фильтр, по индексу которого выбираются файлы (-1 - полное чтение)
+    int partitionFilter = -1; // фильтр = / IN по ключу разбиения: читаются только его партиции
+    double estimate = 0;    // ожидаемое количество строк
+};
+
+enum class JoinMethod { NestedLoop, HashJoin, MergeJoin };
+
+// План SELECT по двум таблицам
+struct Plan {
+    ScanPlan left, right;          // left - таблица первой колонки SELECT
+    JoinMethod method = JoinMethod::NestedLoop;
+    int leftKey = -1, rightKey = -1; // колонки условия соединения
+    bool buildLeft = false;        // hash join: хеш-таблица строится по left
+    vector<Condition> residual;    // условия, проверяемые на парах строк
+    bool anyOf = false;            // условия связаны OR
+    bool partitionWise = false;    // обе таблицы разбиты по ключам соединения: партиции соединяются параллельно
+    double cost = 0;
+};
+
+void initStats(Node* table); // выделение статистики для новой таблицы
+int columnPosition(const Node* table, const string& column); // номер колонки или -1
+TableStats& tableStats(const Node* table); // статистика (собирается при первом обращении)
+void statsOnInsert(const Node* table, const Row& row);
+void statsOnDelete(const Node* table, const Row& row);
+bool buildPlan(const TableJson& json_table, const string& table1, const string& column1, const string& table2, const string& column2,
+               const vector<Condition>& conditions, bool anyOf, Plan& plan);
+void executePlan(const Plan& plan); // чтение таблиц, соединение и вывод пар значений
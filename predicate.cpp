@@ -0,0 +1,165 @@
+#include "predicate.h"
+#include <algorithm>
+
+bool Predicate::matches(const string& value) const {
+    switch (op) {
+        case CompareOp::Eq:
+            return value == values[0];
+        case CompareOp::Less:
+            return value < values[0];
+        case CompareOp::Greater:
+            return value > values[0];
+        case CompareOp::Between:
+            return values[0] <= value && value <= values[1];
+        case CompareOp::Prefix:
+            return value.compare(0, values[0].size(), values[0]) == 0;
+        case CompareOp::In:
+            return binary_search(values.begin(), values.end(), value);
+    }
+    return false;
+}
+
+bool Predicate::mayOverlap(const string& min, const string& max) const {
+    switch (op) {
+        case CompareOp::Eq:
+            return min <= values[0] && values[0] <= max;
+        case CompareOp::Less:
+            return min < values[0];
+        case CompareOp::Greater:
+            return max > values[0];
+        case CompareOp::Between:
+            return !(max < values[0] || values[1] < min);
+        case CompareOp::Prefix: {
+            string end = prefixEnd(values[0]);
+            return max >= values[0] && (end.empty() || min < end);
+        }
+        case CompareOp::In:
+            for (const string& value : values) {
+                if (min <= value && value <= max) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    return true;
+}
+
+string Predicate::describe() const {
+    switch (op) {
+        case CompareOp::Eq:
+            return "= '" + values[0] + "'";
+        case CompareOp::Less:
+            return "< '" + values[0] + "'";
+        case CompareOp::Greater:
+            return "> '" + values[0] + "'";
+        case CompareOp::Between:
+            return "BETWEEN '" + values[0] + "' AND '" + values[1] + "'";
+        case CompareOp::Prefix:
+            return "LIKE '" + values[0] + "%'";
+        case CompareOp::In: {
+            string text = "IN (";
+            for (size_t i = 0; i < values.size(); i++) {
+                text += (i ? ", '" : "'") + values[i] + "'";
+            }
+            return text + ")";
+        }
+    }
+    return "";
+}
+
+bool parseLiteral(const string& token, string& value) {
+    if (token.size() < 2 || token.front() != '\'' || token.back() != '\'') {
+        return false;
+    }
+    value = token.substr(1, token.size() - 2);
+    return true;
+}
+
+string prefixEnd(const string& prefix) {
+    string end = prefix;
+    while (!end.empty() && (unsigned char)end.back() == 0xFF) {
+        end.pop_back();
+    }
+    if (!end.empty()) {
+        end.back()++;
+    }
+    return end;
+}
+
+bool parsePredicate(const string& op, istringstream& iss, Predicate& pred) {
+    pred = Predicate{};
+    string token, value;
+
+    if (op == "=" || op == "<" || op == ">") {
+        pred.op = op == "=" ? CompareOp::Eq : op == "<" ? CompareOp::Less : CompareOp::Greater;
+        if (!(iss >> token) || !parseLiteral(token, value)) {
+            cerr << "Некорректная команда: ожидается значение в кавычках.\n";
+            return false;
+        }
+        pred.values = {value};
+        return true;
+    }
+
+    if (op == "BETWEEN") {
+        string low, high;
+        if (!(iss >> token) || !parseLiteral(token, low) || !(iss >> token) || token != "AND" || !(iss >> token) || !parseLiteral(token, high)) {
+            cerr << "Некорректная команда: ожидается BETWEEN 'a' AND 'b'.\n";
+            return false;
+        }
+        pred.op = CompareOp::Between;
+        pred.values = {low, high};
+        return true;
+    }
+
+    if (op == "LIKE") {
+        if (!(iss >> token) || !parseLiteral(token, value)) {
+            cerr << "Некорректная команда: ожидается LIKE 'префикс%'.\n";
+            return false;
+        }
+        size_t percent = value.find('%');
+        if (percent == string::npos) {
+            pred.values = {value}; // шаблон без % - обычное равенство
+            return true;
+        }
+        if (percent != value.size() - 1) {
+            cerr << "Некорректная команда: поддерживается только LIKE 'префикс%'.\n";
+            return false;
+        }
+        pred.op = CompareOp::Prefix;
+        pred.values = {value.substr(0, percent)};
+        return true;
+    }
+
+    if (op == "IN") {
+        string list; // ('a', 'b') может быть разбит пробелами на несколько слов
+        while (iss >> token) {
+            list += token;
+            if (list.back() == ')') {
+                break;
+            }
+        }
+        if (list.size() < 2 || list.front() != '(' || list.back() != ')') {
+            cerr << "Некорректная команда: ожидается IN ('a', 'b').\n";
+            return false;
+        }
+        istringstream items(list.substr(1, list.size() - 2));
+        while (getline(items, token, ',')) {
+            if (!parseLiteral(token, value)) {
+                cerr << "Некорректная команда: значения IN должны быть в кавычках.\n";
+                return false;
+            }
+            pred.values.push_back(value);
+        }
+        if (pred.values.empty()) {
+            cerr << "Некорректная команда: пустой список IN.\n";
+            return false;
+        }
+        sort(pred.values.begin(), pred.values.end());
+        pred.values.erase(unique(pred.values.begin(), pred.values.end()), pred.values.end());
+        pred.op = CompareOp::In;
+        return true;
+    }
+
+    cerr << "Некорректная команда: неизвестный оператор " << op << ".\n";
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Сравнение колонки со строковыми литералами
+enum class CompareOp { Eq, Less, Greater, Between, Prefix, In };
+
+struct Predicate {
+    CompareOp op = CompareOp::Eq;
+    vector<string> values; // Between: {нижняя, верхняя}; In: список; иначе одно значение
+
+    bool matches(const string& value) const;
+    bool mayOverlap(const string& min, const string& max) const; // есть ли подходящие значения в [min, max]
+    bool exactValues() const { return op == CompareOp::Eq || op == CompareOp::In; } // можно проверять фильтром Блума
+    string describe() const;
+};
+
+// Разбор правой части условия после колонки: = 'a' | < 'a' | > 'a' | BETWEEN 'a' AND 'b' | LIKE 'a%' | IN ('a', 'b')
+bool parsePredicate(const string& op, istringstream& iss, Predicate& pred);
+bool parseLiteral(const string& token, string& value); // 'value' -> value
+string prefixEnd(const string& prefix); // первая строка после всех строк с префиксом (пусто - без границы)
+
+// Обход элементов упорядоченного контейнера (map/multimap по строке), ключ которых подходит под условие
+template <typename Map, typename Func>
+void forEachMatch(const Map& items, const Predicate& pred, Func func) {
+    auto visit = [&](auto from, auto to) {
+        for (auto it = from; it != to; ++it) {
+            func(*it);
+        }
+    };
+    switch (pred.op) {
+        case CompareOp::Eq:
+        case CompareOp::In:
+            for (const string& value : pred.values) {
+                auto range = items.equal_range(value);
+                visit(range.first, range.second);
+            }
+            break;
+        case CompareOp::Less:
+            visit(items.begin(), items.lower_bound(pred.values[0]));
+            break;
+        case CompareOp::Greater:
+            visit(items.upper_bound(pred.values[0]), items.end());
+            break;
+        case CompareOp::Between:
+            if (pred.values[0] <= pred.values[1]) {
+                visit(items.lower_bound(pred.values[0]), items.upper_bound(pred.values[1]));
+            }
+            break;
+        case CompareOp::Prefix: {
+            string end = prefixEnd(pred.values[0]);
+            visit(items.lower_bound(pred.values[0]), end.empty() ? items.end() : items.lower_bound(end));
+            break;
+        }
+    }
+}
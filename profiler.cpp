@@ -0,0 +1,165 @@
+#include "profiler.h"
+#include "select.h"
+#include "json.hpp"
+#include <iomanip>
+#include <map>
+#include <mutex>
+
+using json = nlohmann::json;
+
+namespace {
+    thread_local QueryProfile profile; // профиль запроса текущего потока
+    thread_local int depth = 0;        // вложенность QueryScope
+    thread_local OperatorStats scratch; // оператор вне QueryScope, никуда не попадает
+
+    // Метрики, накопленные по всем запросам
+    mutex metricsMutex;
+    map<string, size_t> queryCount;     // количество запросов по типу
+    map<string, OperatorStats> totals;  // суммарные счётчики по виду оператора (OperatorStats::kind)
+
+    double toMs(chrono::nanoseconds ns) {
+        return chrono::duration<double, milli>(ns).count();
+    }
+}
+
+QueryScope::QueryScope(const string& command) : owner(depth++ == 0), start(chrono::steady_clock::now()) {
+    if (owner) {
+        profile = QueryProfile{command};
+    }
+}
+
+QueryScope::~QueryScope() {
+    depth--;
+    if (!owner) {
+        return;
+    }
+    profile.total = chrono::steady_clock::now() - start;
+
+    istringstream iss(profile.command);
+    string kind;
+    iss >> kind;
+
+    lock_guard<mutex> lock(metricsMutex);
+    queryCount[kind]++;
+    for (const auto& op : profile.operators) {
+        OperatorStats& sum = totals[op.kind];
+        sum.name = op.kind;
+        sum.time += op.time;
+        sum.rowsIn += op.rowsIn;
+        sum.rowsOut += op.rowsOut;
+        sum.chunksOpened += op.chunksOpened;
+        sum.chunksSkipped += op.chunksSkipped;
+        sum.bytesRead += op.bytesRead;
+        sum.lockIo += op.lockIo;
+    }
+}
+
+OperatorStats& profileOperator(const string& name, const string& kind) {
+    OperatorStats op{name, kind.empty() ? name : kind};
+    if (depth == 0) {
+        scratch = op;
+        return scratch;
+    }
+    profile.operators.push_back(op);
+    return profile.operators.back();
+}
+
+void mergeStats(OperatorStats& into, const OperatorStats& part) {
+    into.time += part.time;
+    into.rowsIn += part.rowsIn;
+    into.rowsOut += part.rowsOut;
+    into.chunksOpened += part.chunksOpened;
+    into.chunksSkipped += part.chunksSkipped;
+    into.bytesRead += part.bytesRead;
+    into.lockIo += part.lockIo;
+}
+
+void countChunk(OperatorStats& stats, const fs::path& filePath) {
+    stats.chunksOpened++;
+    error_code ec;
+    uintmax_t size = fs::file_size(filePath, ec);
+    if (!ec) {
+        stats.bytesRead += size;
+    }
+}
+
+const QueryProfile& currentProfile() {
+    return profile;
+}
+
+void printProfile(const QueryProfile& profile, ostream& out) {
+    out << "EXPLAIN ANALYZE: " << profile.command << "\n";
+    for (const auto& op : profile.operators) {
+        out << "  -> " << op.name << fixed << setprecision(3)
+            << "  time=" << toMs(op.time) << "ms"
+            << " rows_in=" << op.rowsIn
+            << " rows_out=" << op.rowsOut
+            << " chunks=" << op.chunksOpened
+            << " skipped=" << op.chunksSkipped
+            << " bytes=" << op.bytesRead
+            << " lock_io=" << toMs(op.lockIo) << "ms\n";
+    }
+    out << "Итого: " << fixed << setprecision(3) << toMs(profile.total) << "ms\n";
+}
+
+void dumpMetrics(ostream& out) {
+    lock_guard<mutex> lock(metricsMutex);
+    json metrics;
+    metrics["queries"] = queryCount;
+    metrics["operators"] = json::object();
+    for (const auto& [name, op] : totals) {
+        metrics["operators"][name] = {
+            {"time_ms", toMs(op.time)},
+            {"rows_in", op.rowsIn},
+            {"rows_out", op.rowsOut},
+            {"chunks_opened", op.chunksOpened},
+            {"chunks_skipped", op.chunksSkipped},
+            {"bytes_read", op.bytesRead},
+            {"lock_io_ms", toMs(op.lockIo)},
+        };
+    }
+    out << metrics.dump(2) << endl;
+}
+
+void resetMetrics() {
+    lock_guard<mutex> lock(metricsMutex);
+    queryCount.clear();
+    totals.clear();
+}
+
+bool explainAnalyze(const string& command, const TableJson& json_table) {
+    istringstream iss(command);
+    string slovo;
+    iss >> slovo;
+    if (slovo == "EXPLAIN") { // префикс EXPLAIN ANALYZE необязателен
+        iss >> slovo;
+        if (slovo != "ANALYZE") {
+            cerr << "Некорректная команда: ожидается EXPLAIN ANALYZE.\n";
+            return false;
+        }
+        iss >> slovo;
+    }
+
+    string query;
+    getline(iss, query);
+    query = slovo + query;
+
+    if (slovo != "SELECT" && slovo != "INSERT" && slovo != "DELETE") {
+        cerr << "Некорректная команда.\n";
+        return false;
+    }
+
+    bool done;
+    {
+        QueryScope scope(query); // внешний профиль, вложенные команды пишут в него
+        if (slovo == "SELECT") {
+            done = select(query, json_table);
+        } else if (slovo == "INSERT") {
+            done = insert(query, json_table);
+        } else {
+            done = delet(query, json_table);
+        }
+    } // здесь профиль закрыт и посчитано общее время
+    printProfile(currentProfile(), cout);
+    return done;
+}
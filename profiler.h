@@ -0,0 +1,63 @@
+#pragma once
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include "Node.h"
+
+using namespace std;
+namespace fs = filesystem;
+
+// Счётчики одного оператора запроса
+struct OperatorStats {
+    string name;
+    string kind;                     // ключ в SHOW METRICS: вид оператора и таблица, без оценок и литералов
+    chrono::nanoseconds time{0};     // время работы оператора
+    size_t rowsIn = 0;               // просмотрено строк
+    size_t rowsOut = 0;              // строк прошло дальше
+    size_t chunksOpened = 0;         // открыто csv файлов
+    size_t chunksSkipped = 0;        // файлов пропущено без чтения (фильтр Блума, индекс блоков)
+    size_t bytesRead = 0;            // прочитано байт
+    chrono::nanoseconds lockIo{0};   // чтение/запись файла блокировки (ожидания нет: занятая таблица - отказ)
+};
+
+// Профиль текущего запроса (у каждого потока свой)
+struct QueryProfile {
+    string command;
+    chrono::nanoseconds total{0};
+    deque<OperatorStats> operators; // deque: ссылки на операторы не инвалидируются
+};
+
+// Замер времени до конца области видимости
+class ScopedTimer {
+public:
+    explicit ScopedTimer(chrono::nanoseconds& target) : target(target), start(chrono::steady_clock::now()) {}
+    ~ScopedTimer() { target += chrono::steady_clock::now() - start; }
+private:
+    chrono::nanoseconds& target;
+    chrono::steady_clock::time_point start;
+};
+
+// Граница запроса: внешний QueryScope начинает профиль, а по завершении
+// добавляет его в общие метрики. Вложенные QueryScope ничего не делают.
+class QueryScope {
+public:
+    explicit QueryScope(const string& command);
+    ~QueryScope();
+private:
+    bool owner;
+    chrono::steady_clock::time_point start;
+};
+
+// Новый оператор в профиле текущего запроса. Вне QueryScope профиля нет:
+// возвращается общий для потока черновик, который сбрасывается при каждом вызове.
+// name выводит EXPLAIN ANALYZE, метрики копятся по kind (пустой - по name).
+OperatorStats& profileOperator(const string& name, const string& kind = "");
+void countChunk(OperatorStats& stats, const fs::path& filePath); // учёт открытого csv файла
+void mergeStats(OperatorStats& into, const OperatorStats& part); // сложение счётчиков частей оператора
+const QueryProfile& currentProfile();
+void printProfile(const QueryProfile& profile, ostream& out); // вывод в стиле EXPLAIN ANALYZE
+void dumpMetrics(ostream& out); // накопленные метрики всех запросов в JSON
+void resetMetrics();
+bool explainAnalyze(const string& command, const TableJson& json_table); // EXPLAIN ANALYZE <SELECT|INSERT|DELETE ...>
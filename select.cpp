@@ -72,82 +72,51 @@ bool findDot(const string& indication) {
     return dot;
 }
 
-// Функция для обработки одного условия
-bool processConditionString(const TableJson& json_table, const string& table, const string& column, const string& s) {
-   if (!s.empty()){
-    int cntCsv = findCsvFileCount(json_table, table);
-        for (size_t i = 1; i <= cntCsv; i++) { // просматриваем все созданные файлы csv
-            string filePath = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + table + "/" + to_string(i) + ".csv";
-            rapidcsv::Document doc(filePath); // открываем файл
-            int columnIndex = doc.GetColumnIdx(column); // считываем индекс искомой колонки
-            size_t cntRow = doc.GetRowCount(); // считываем количество строк в файле
-            for (size_t i = 0; i < cntRow; ++i) {
-                string cellValue = doc.GetCell<string>(columnIndex, i);
-                if (cellValue == s) {
-                    cout << "Сравнение с значением"<<endl;
-                    cout << "Таблица "<<table<<"(" << column << "): " <<cellValue << " = "<< s << endl;
-                    return true;
-                }
-                else{
-                    cerr << "Нет такого значения в таблице";
-                }
-            }
+// Все значения колонки таблицы (из памяти или из csv файлов)
+vector<string> columnValues(const Node* table, const string& column, OperatorStats& stats) {
+    vector<string> values;
+    int position = columnPosition(table, column);
+    if (isInMemory(table)) {
+        memScan(table, [&](const Row& row) { values.push_back(row[position]); });
+        return values;
+    }
+    for (int iCsv : tableChunks(table)) {
+        rapidcsv::Document doc = readChunk(table, iCsv, &stats);
+        for (size_t r = 0; r < doc.GetRowCount(); ++r) {
+            values.push_back(doc.GetCell<string>(position, r));
         }
-   }
-    return false; // Если ничего не нашли
+    }
+    return values;
 }
 
-bool processConditionTable(const TableJson& json_table, const string& table1, const string& table2, const string& column1, const string& column2){
-        bool condition = true;
-        int cntCsv1 = findCsvFileCount(json_table, table1);
-        int cntCsv2 = findCsvFileCount(json_table, table2);
-
-        for (size_t iCsv = 1; iCsv <= cntCsv1; iCsv++) {
-            for (size_t icsv = 1; icsv <= cntCsv2; icsv++){
-                string filePath1 = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + table1 + "/" + to_string(iCsv) + ".csv";
-                rapidcsv::Document doc1(filePath1); // открываем файл
-                int columnIndex1 = doc1.GetColumnIdx(column1); // считываем индекс искомой колонки
-                size_t cntRow1 = doc1.GetRowCount(); // считываем количество строк в файле
-
-                string filePath2 = "/mnt/c/Users/Николай/practice 2/Practice 1.3/" + json_table.Name + "/" + table2 + "/" + to_string(icsv) + ".csv";
-                rapidcsv::Document doc2(filePath2); // открываем файл
-                size_t cntRow2 = doc2.GetRowCount(); // считываем количество строк в файле
-                int columnIndex2 = doc2.GetColumnIdx(column2); // считываем индекс искомой колонки
-                if(cntRow1 == cntRow2){
-                    for (size_t i = 0; i < cntRow1; ++i) { // проходимся по строкам
-                    string value1 = doc1.GetCell<string>(columnIndex1, i);
-                    string value2 = doc2.GetCell<string>(columnIndex2, i);
-                    // Сравниваем значения колонок
-                    if (value1 != value2) {
-                        condition = false;
-                        cerr << " Значения в таблицах не равны";
-                    }
-                    if(value1 == value2){
-                        condition = true;
-                        cout << "Сравнение таблиц"<<endl;
-                        cout << "Таблица1 (" << column1 << "): " << value1 << " | Таблица2 (" << column2 << "): " << value2 << endl;  
-                    }
-                }
-            } else {
-                cerr << "Количество строк в таблицах не совпадает" << endl;
-                return false;
+// Функция для выполнения кросс-соединения
+void crossJoinAndFilter(const TableJson& json_table, const string& table1, const string& table2, const string& column1, const string& column2) {
+    OperatorStats& stats = profileOperator("CrossJoin " + table1 + " x " + table2);
+    ScopedTimer timer(stats.time);
+    const Node* tableNode1 = FindTable(json_table.Tablehead, table1);
+    const Node* tableNode2 = FindTable(json_table.Tablehead, table2);
+
+    // С таблицей в памяти значения обеих колонок собираются заранее
+    if (isInMemory(tableNode1) || isInMemory(tableNode2)) {
+        vector<string> values1 = columnValues(tableNode1, column1, stats);
+        vector<string> values2 = columnValues(tableNode2, column2, stats);
+        stats.rowsIn += values1.size() * values2.size();
+        for (const string& val1 : values1) {
+            for (const string& val2 : values2) {
+                cout << "Таблица1 (" << column1 << "): " << val1 << " | Таблица2 (" << column2 << "): " << val2 << endl;
+                stats.rowsOut++;
             }
         }
+        return;
     }
 
-    return condition;
-}
-
-
-// Функция для выполнения кросс-соединения
-void crossJoinAndFilter(const TableJson& json_table, const string& table1, const string& table2, const string& column1, const string& column2) {
-    int csvCNT1 = findCsvFileCount(json_table, table1); 
-    int csvCNT2 = findCsvFileCount(json_table, table2); 
+    vector<int> chunks1 = tableChunks(tableNode1);
+    vector<int> chunks2 = tableChunks(tableNode2);
 
     // Перебор файлов из таблицы 1
-    for (size_t iCsv1 = 1; iCsv1 <= csvCNT1; ++iCsv1) {
-        string filePath1 = "/mnt/c/Users/Николай/practice 2/Practice 1.3/MySchemaJson/CLASSTEAMS/" + to_string(iCsv1) + ".csv";
-        rapidcsv::Document doc1(filePath1); 
+    for (int iCsv1 : chunks1) {
+        string filePath1 = chunkPath(tableNode1, iCsv1).string();
+        rapidcsv::Document doc1 = readChunk(tableNode1, iCsv1, &stats);
 
         int columnIndex1 = doc1.GetColumnIdx(column1);
         if (columnIndex1 == -1) {
@@ -162,9 +131,9 @@ void crossJoinAndFilter(const TableJson& json_table, const string& table1, const
         }
 
         // Перебор файлов из таблицы 2
-        for (size_t iCsv2 = 1; iCsv2 <= csvCNT2; ++iCsv2) {
-            string filePath2 = "/mnt/c/Users/Николай/practice 2/Practice 1.3/MySchemaJson/STUDENT/" + to_string(iCsv2) + ".csv";
-            rapidcsv::Document doc2(filePath2); 
+        for (int iCsv2 : chunks2) {
+            string filePath2 = chunkPath(tableNode2, iCsv2).string();
+            rapidcsv::Document doc2 = readChunk(tableNode2, iCsv2, &stats);
 
             int columnIndex2 = doc2.GetColumnIdx(column2);
             if (columnIndex2 == -1) {
@@ -178,12 +147,14 @@ void crossJoinAndFilter(const TableJson& json_table, const string& table1, const
                 return;
             }
 
+            stats.rowsIn += rows1 * rows2;
             for (size_t r1 = 0; r1 < rows1; ++r1) {
                 string val1 = doc1.GetCell<string>(columnIndex1, r1);
 
                 for (size_t r2 = 0; r2 < rows2; ++r2) {
                     string val2 = doc2.GetCell<string>(columnIndex2, r2);
                     cout << "Таблица1 (" << column1 << "): " << val1 << " | Таблица2 (" << column2 << "): " << val2 << endl;
+                    stats.rowsOut++;
                 }
             }
         }
@@ -191,7 +162,8 @@ void crossJoinAndFilter(const TableJson& json_table, const string& table1, const
 }
 
 
-void select(const string& query, const TableJson& json_table) {
+bool select(const string& query, const TableJson& json_table) {
+    QueryScope scope(query);
     istringstream iss(query);
     string slovo;
 
@@ -199,7 +171,7 @@ void select(const string& query, const TableJson& json_table) {
     iss >> slovo; // "SELECT"
     if (slovo != "SELECT") {
         cerr << "Некорректная команда: отсутствует SELECT.\n";
-        return;
+        return false;
     }
 
     // Считываем первую таблицу и колонку
@@ -216,20 +188,20 @@ void select(const string& query, const TableJson& json_table) {
     iss >> slovo; // "FROM"
     if (slovo != "FROM") {
         cerr << "Некорректная команда: отсутствует FROM.\n";
-        return;
+        return false;
     }
 
     // Считываем таблицы
     iss >> slovo; // таблица 1
     if (slovo != table1) {
         cerr << "Некорректная команда: первая таблица не совпадает.\n";
-        return;
+        return false;
     }
 
     iss >> slovo; // таблица 2
     if (slovo != table2) {
         cerr << "Некорректная команда: вторая таблица не совпадает.\n";
-        return;
+        return false;
     }
 
     // Проверка на наличие "WHERE"
@@ -237,54 +209,43 @@ void select(const string& query, const TableJson& json_table) {
         // Если "WHERE" отсутствует, выполняем crossJoin
         crossJoinAndFilter(json_table, table1, table2, column1, column2);
         cout << "Выполняем cross join без условий.\n";
-        return;
+        return true;
     }
 
-    // Первое условие
-    string slovo1, slovo2;
-    iss >> slovo1; // table1.column1
-    string t1, c1;
-    separationDot(slovo1, t1, c1, json_table);  // Разделяем на таблицу и колонку
-
-    iss >> slovo; // "="
-
-    iss >> slovo2; //table2.column2
-
-    bool firstCondition = false;
-
-    string t2, c2;
-    separationDot(slovo2, t2, c2, json_table);  // Разделяем вторую колонку
-
-    // Проводим проверку на равенство колонок
-    firstCondition = processConditionTable(json_table, t1, t2, c1, c2);
-
-    // Далее проверка на AND / OR
-    string oper;
-    if (iss >> oper && (oper == "AND" || oper == "OR")) {
-
-        string conditionValue2;
-        iss >> slovo; // STUDENT.CURS (или другая колонка)
-        string t3, c3;
-        separationDot(slovo, t3, c3, json_table);  // Разделяем на таблицу и колонку
-
-        iss >> slovo; // "="
-        iss >> conditionValue2; // Значение или колонка для второго условия
-
-        bool secondCondition = false;
-        // если значение в кавычках, то это строка
-        string cleanedconditionValue2 = ignoreQuotes(conditionValue2);
-        secondCondition = processConditionString(json_table, t3, c3, cleanedconditionValue2);
-
-        // Логика для оператора AND
-        if (oper == "AND" && (firstCondition && secondCondition)) {
-            crossJoinAndFilter(json_table, table1, table2, column1, column2);
+    // Условия WHERE: table.column = table.column | table.column <оператор> 'value', связанные AND либо OR
+    vector<Condition> conditions;
+    string oper, connective;
+    do {
+        if (!connective.empty() && oper != connective) {
+            cerr << "Некорректная команда: AND и OR в одном условии не поддерживаются.\n";
+            return false;
         }
-        // Логика для оператора OR
-        else if (oper == "OR" && (firstCondition || secondCondition)) {
-            crossJoinAndFilter(json_table, table1, table2, column1, column2);
-        }
-        else{
-            cerr << "Условия не выполняются" << endl;
+        connective = oper;
+
+        Condition cond;
+        iss >> slovo; // table.column
+        separationDot(slovo, cond.table1, cond.column1, json_table);  // Разделяем на таблицу и колонку
+
+        string op;
+        iss >> op; // =, <, >, BETWEEN, LIKE, IN
+        if (op == "=") {
+            iss >> slovo; // значение в кавычках или table.column
+            if (!slovo.empty() && slovo.front() == '\'') {
+                cond.pred.values = {ignoreQuotes(slovo)}; // если значение в кавычках, то это строка
+            } else {
+                separationDot(slovo, cond.table2, cond.column2, json_table);
+            }
+        } else if (!parsePredicate(op, iss, cond.pred)) {
+            return false;
         }
+        conditions.push_back(cond);
+    } while (iss >> oper && (oper == "AND" || oper == "OR"));
+
+    // Планировщик выбирает порядок фильтров и способ соединения по статистике таблиц
+    Plan plan;
+    if (!buildPlan(json_table, table1, column1, table2, column2, conditions, connective == "OR", plan)) {
+        return false;
     }
+    executePlan(plan);
+    return true;
 }
@@ -1,16 +1,16 @@
 #pragma once
 #include <iostream>
 #include "Node.h"
-#include "delete.h"
+#include "delet.h"
 #include "insert.h"
+#include "planner.h"
 
 
 using namespace std;
 
 
-void select(const string& query, const TableJson& json_table);
-bool processConditionTable(const TableJson& json_table, const string& table1, const string& table2, const string& column1, const string& column2);
-bool processConditionString(const TableJson& json_table, const string& table, const string& column, const string& s);
+bool select(const string& query, const TableJson& json_table); // false - команда не выполнена
+vector<string> columnValues(const Node* table, const string& column, OperatorStats& stats);
 void crossJoinAndFilter(const TableJson& json_table, const string& table1, const string& table2, const string& column1, const string& column2);
 bool findDot(const string& indication);
 string ignoreQuotes(const string& indication);
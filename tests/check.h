@@ -0,0 +1,47 @@
+#pragma once
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../parcer.h"
+
+// Минимальные проверки для tests/: каждая программа запускается в пустом
+// каталоге (make check), создаёт schema.json, печатает проваленные проверки
+// и возвращает их число.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": не выполнено: " #cond "\n"; \
+            checkFailures()++; \
+        } \
+    } while (0)
+
+// Схема из строки JSON; вывод parser о созданных файлах не нужен
+inline TableJson loadSchema(const std::string& schema) {
+    std::ofstream("schema.json") << schema;
+    TableJson json_table{};
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    parser(json_table);
+    std::cout.rdbuf(saved);
+    return json_table;
+}
+
+// Всё, что команда напечатала в cout
+inline std::string captureOutput(const std::function<void()>& run) {
+    std::ostringstream out;
+    std::streambuf* saved = std::cout.rdbuf(out.rdbuf());
+    run();
+    std::cout.rdbuf(saved);
+    return out.str();
+}
+
+inline int checkResult(const char* name) {
+    std::cout << name << ": " << (checkFailures() ? "ошибки: " + std::to_string(checkFailures()) : std::string("ok")) << "\n";
+    return checkFailures();
+}
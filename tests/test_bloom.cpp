@@ -0,0 +1,52 @@
+#include "check.h"
+#include "../insert.h"
+#include "../delet.h"
+#include "../bloom.h"
+#include "../hash.h"
+
+// Фильтры Блума: строятся при заполнении файла, не дают ложных "нет" и не зависят от сборки
+int main() {
+    CHECK(stableHash("abc") == 0xe71fa2190541574bULL); // эталонное значение FNV-1a
+
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 100, "structure": {"A": ["a", "b"]}})");
+    const Node* table = FindTable(json_table.Tablehead, "A");
+    for (int i = 0; i < 200; i++) {
+        insert("INSERT INTO A VALUES ('v" + to_string(i) + "', 'b')", json_table);
+    }
+
+    // После DELETE в заполненный файл не дописывают: его фильтр остался бы без новой строки
+    delet("DELETE FROM A WHERE A.a = 'v150'", json_table);
+    insert("INSERT INTO A VALUES ('new', 'b')", json_table);
+    CHECK(readChunk(table, 2).GetRowCount() == 99);
+    CHECK(readChunk(table, 3).GetRowCount() == 1);
+
+    fs::path bloom1 = chunkPath(table, 1).replace_extension(".bloom");
+    CHECK(fs::exists(bloom1));
+    CHECK(fs::exists(chunkPath(table, 2).replace_extension(".bloom")));
+    CHECK(!fs::exists(chunkPath(table, 3).replace_extension(".bloom"))); // файл ещё дописывается
+    CHECK(bloomSealed(table, 1));
+    CHECK(!bloomSealed(table, 3));
+
+    int falsePositives = 0;
+    for (int i = 0; i < 100; i++) {
+        CHECK(chunkMayContain(table, 1, 1, "v" + to_string(i)));
+        falsePositives += chunkMayContain(table, 1, 1, "w" + to_string(i));
+    }
+    CHECK(falsePositives < 10);
+    CHECK(chunkMayContain(table, 3, 1, "нет такого")); // без фильтра файл читается
+
+    // N.bloom старой версии не читается, а строится заново по файлу
+    {
+        fstream file(bloom1, ios::in | ios::out | ios::binary);
+        uint32_t version = 1;
+        file.seekp(4);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    table->blooms->chunks.clear(); // как после перезапуска
+    for (int i = 0; i < 100; i++) {
+        CHECK(chunkMayContain(table, 1, 1, "v" + to_string(i)));
+    }
+    table->blooms->chunks.clear();
+    CHECK(chunkMayContain(table, 1, 1, "v5")); // перезаписанный файл читается
+    return checkResult("bloom");
+}
@@ -0,0 +1,46 @@
+#include "check.h"
+#include "../insert.h"
+#include "../delet.h"
+#include "../changefeed.h"
+#include <thread>
+
+// Журнал изменений: порядок и смещения событий, экранирование значений, ожидание подписчика
+int main() {
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 10, "structure": {"A": ["a", "b"]}})");
+    const Node* table = FindTable(json_table.Tablehead, "A");
+
+    insert("INSERT INTO A VALUES ('x,y', 'p\\q')", json_table);
+    for (int i = 0; i < 4; i++) {
+        insert("INSERT INTO A VALUES ('v" + to_string(i) + "', 'b')", json_table);
+    }
+    delet("DELETE FROM A WHERE A.a = 'v2'", json_table);
+
+    ChangeBatch all = readChanges(table, 0, 100);
+    CHECK(all.events.size() == 6);
+    CHECK(all.events[0].type == ChangeType::Insert);
+    CHECK(all.events[0].row == vector<string>({"1", "x,y", "p\\q"})); // запятая и \ не ломают разбор
+    CHECK(all.events[5].type == ChangeType::Delete);
+    CHECK(all.events[5].row == vector<string>({"4", "v2", "b"}));
+    CHECK(all.nextOffset == fs::file_size(table->feed->path));
+
+    // Чтение пачками с сохранённого смещения даёт те же события
+    ChangeBatch first = readChanges(table, 0, 4);
+    ChangeBatch rest = readChanges(table, first.nextOffset, 100);
+    CHECK(first.events.size() == 4 && rest.events.size() == 2);
+    CHECK(rest.events[0].offset == all.events[4].offset);
+    CHECK(rest.events[1].row == all.events[5].row);
+    CHECK(readChanges(table, all.nextOffset, 100).events.empty());
+
+    // Подписчик ждёт новые события и не получает старые
+    ChangeSubscription subscription(table, all.nextOffset);
+    CHECK(subscription.poll(chrono::milliseconds(10)).events.empty());
+    thread writer([&] {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        insert("INSERT INTO A VALUES ('late', 'b')", json_table);
+    });
+    ChangeBatch late = subscription.poll(chrono::seconds(5));
+    writer.join();
+    CHECK(late.events.size() == 1 && late.events[0].row[1] == "late");
+    CHECK(subscription.offset() == fs::file_size(table->feed->path));
+    return checkResult("changefeed");
+}
@@ -0,0 +1,95 @@
+#include "check.h"
+#include "../insert.h"
+#include "../delet.h"
+#include "../chunk.h"
+
+// Запечатанные файлы: сжатие lz4/zstd, чтение блоков, кавычки в значениях и отказ на повреждённых файлах
+namespace {
+    const int kRows = 600;
+
+    void fill(const TableJson& json_table, const string& table) {
+        for (int i = 0; i < kRows; i++) {
+            string value = i == 7 ? "x,\"7\"" : "v" + to_string(1000 + i);
+            insert("INSERT INTO " + table + " VALUES ('" + value + "', 'k" + to_string(i % 3) + "')", json_table);
+        }
+    }
+
+    void patch(const fs::path& path, uint64_t offset, uint32_t value) {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    uint64_t readOffset(const fs::path& path) {
+        ifstream file(path, ios::binary);
+        file.seekg(-int(sizeof(uint64_t) + 4), ios::end);
+        uint64_t offset = 0;
+        file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+        return offset;
+    }
+}
+
+int main() {
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 300, "structure": {
+        "L": {"columns": ["a", "b"], "compression": "lz4"},
+        "Z": {"columns": ["a", "b"], "compression": "zstd"}}})");
+
+    for (const char* name : {"L", "Z"}) {
+        const Node* table = FindTable(json_table.Tablehead, name);
+        fill(json_table, name);
+        CHECK(isCompressed(table, 1));
+        CHECK(isCompressed(table, 2));
+        CHECK(!fs::exists(chunkPath(table, 1)));
+
+        rapidcsv::Document doc = readChunk(table, 1);
+        CHECK(doc.GetRowCount() == 300);
+        CHECK(doc.GetCell<string>(1, 7) == "x,\"7\""); // значение с запятой и кавычками пережило сжатие
+        CHECK(doc.GetCell<string>(1, 299) == "v1299");
+
+        // Блоки, где по min/max нет нужных значений, не распаковываются
+        OperatorStats stats;
+        rapidcsv::Document part = readChunk(table, 2, &stats, [](const ChunkBlock& block) { return block.min[1] >= "v1550"; });
+        CHECK(part.GetRowCount() == 300 - kBlockRows);
+        CHECK(stats.chunksOpened == 1);
+    }
+
+    // Повреждённые файлы не читаются и не вызывают огромных выделений памяти
+    const Node* table = FindTable(json_table.Tablehead, "L");
+    fs::path path = chunkPath(table, 1).string() + ".lz4";
+    fs::path backup = path.string() + ".bak";
+    fs::copy_file(path, backup);
+    ChunkIndex index;
+
+    fs::resize_file(path, fs::file_size(path) - 2); // оборванная запись: нет футера
+    CHECK(!readChunkIndex(table, 1, index));
+
+    fs::copy_file(backup, path, fs::copy_options::overwrite_existing);
+    patch(path, 5, 0xFFFFFFF0u); // длина заголовка
+    CHECK(!readChunkIndex(table, 1, index));
+
+    fs::copy_file(backup, path, fs::copy_options::overwrite_existing);
+    uint64_t indexOffset = readOffset(path);
+    patch(path, indexOffset, 0x7FFFFFFFu); // число блоков
+    CHECK(!readChunkIndex(table, 1, index));
+
+    fs::copy_file(backup, path, fs::copy_options::overwrite_existing);
+    patch(path, indexOffset + 2 * sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t), 0xFFFFFFF0u); // размер первого блока
+    CHECK(readChunkIndex(table, 1, index));
+    bool complete = true;
+    readChunk(table, 1, nullptr, nullptr, &complete);
+    CHECK(!complete); // испорченный блок не прочитан - об этом сообщается
+
+    // DELETE не перезаписывает файл с испорченным блоком: иначе пропали бы все его строки
+    fs::path corrupted = path.string() + ".bad";
+    fs::copy_file(path, corrupted);
+    delet("DELETE FROM L WHERE L.a = 'v1299'", json_table);
+    ifstream left(path, ios::binary), right(corrupted, ios::binary);
+    CHECK(string(istreambuf_iterator<char>(left), {}) == string(istreambuf_iterator<char>(right), {}));
+
+    fs::copy_file(backup, path, fs::copy_options::overwrite_existing);
+    complete = false;
+    CHECK(readChunk(table, 1, nullptr, nullptr, &complete).GetRowCount() == 300 && complete);
+    CHECK(delet("DELETE FROM L WHERE L.a = 'v1299'", json_table)); // целый файл снова изменяется
+    CHECK(readChunk(table, 1).GetRowCount() == 299);
+    return checkResult("compression");
+}
@@ -0,0 +1,78 @@
+#include "check.h"
+#include "../select.h"
+#include "../memtable.h"
+#include <thread>
+
+// Таблица в памяти: INSERT/DELETE/SELECT без файлов и снимки, переписывающие только изменённые файлы
+namespace {
+    size_t chunkRows(const Node* table, int csvNumber) {
+        return readChunk(table, csvNumber).GetRowCount();
+    }
+
+    fs::file_time_type modified(const Node* table, int csvNumber) {
+        fs::path path = chunkPath(table, csvNumber);
+        return fs::last_write_time(fs::exists(path) ? path : fs::path(path.string() + ".lz4"));
+    }
+}
+
+int main() {
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 10, "structure": {
+        "M": {"columns": ["a"], "in_memory": true, "compression": "lz4", "snapshot_interval_ms": 600000},
+        "B": ["c"]}})");
+    const Node* table = FindTable(json_table.Tablehead, "M");
+    for (int i = 0; i < 25; i++) {
+        insert("INSERT INTO M VALUES ('v" + to_string(100 + i) + "')", json_table);
+    }
+    insert("INSERT INTO B VALUES ('v110')", json_table);
+    CHECK(!chunkExists(table, 1)); // до снимка на диске ничего нет
+
+    string output = captureOutput([&] { select("SELECT M.a B.c FROM M B WHERE M.a = B.c", json_table); });
+    CHECK(output.find("Таблица1 (a): v110 | Таблица2 (c): v110") != string::npos);
+
+    snapshotTable(table);
+    CHECK(isCompressed(table, 1) && isCompressed(table, 2) && !isCompressed(table, 3));
+    CHECK(chunkRows(table, 1) == 10 && chunkRows(table, 2) == 10 && chunkRows(table, 3) == 5);
+    CHECK(readChunk(table, 3).GetCell<string>(1, 4) == "v124");
+
+    // Вставка в конец переписывает только последний файл
+    auto first = modified(table, 1);
+    this_thread::sleep_for(chrono::milliseconds(20));
+    insert("INSERT INTO M VALUES ('v125')", json_table);
+    snapshotTable(table);
+    CHECK(modified(table, 1) == first);
+    CHECK(chunkRows(table, 3) == 6);
+
+    // Удаление из второго файла сдвигает строки: переписываются файлы со второго
+    delet("DELETE FROM M WHERE M.a = 'v112'", json_table);
+    snapshotTable(table);
+    CHECK(modified(table, 1) == first);
+    CHECK(chunkRows(table, 2) == 10 && readChunk(table, 2).GetCell<string>(1, 2) == "v113");
+    CHECK(chunkRows(table, 3) == 5);
+
+    // Удаление почти всех строк: лишние файлы прошлого снимка убираются, сжатый файл заменяется обычным
+    delet("DELETE FROM M WHERE M.a > 'v102'", json_table);
+    snapshotTable(table);
+    CHECK(!isCompressed(table, 1) && chunkRows(table, 1) == 3);
+    CHECK(!chunkExists(table, 2) && !chunkExists(table, 3));
+    CHECK(!fs::exists(chunkPath(table, 1).string() + ".lz4"));
+
+    // Ошибка замены файла не бросает исключение: таблица остаётся изменённой, и следующий снимок повторяет запись
+    fs::path blocked = chunkPath(table, 1);
+    fs::remove(blocked);
+    fs::create_directories(blocked / "busy");
+    insert("INSERT INTO M VALUES ('retry')", json_table);
+    snapshotTable(table);
+    CHECK(fs::is_directory(blocked) && !fs::exists(blocked.string() + ".tmp"));
+    fs::remove_all(blocked);
+    snapshotTable(table);
+    CHECK(chunkRows(table, 1) == 4);
+
+    insert("INSERT INTO M VALUES ('last')", json_table);
+    shutdownMemTables(json_table); // последний снимок
+    CHECK(chunkRows(table, 1) == 5);
+    ifstream pk(table->pkFile);
+    int lastPk = 0;
+    pk >> lastPk;
+    CHECK(lastPk == 28);
+    return checkResult("memtable");
+}
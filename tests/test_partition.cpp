@@ -0,0 +1,100 @@
+#include "check.h"
+#include "../select.h"
+#include "../delet.h"
+#include "../partition.h"
+#include <algorithm>
+
+// Разбиение по хешу колонки: раскладка строк, чтение нужных партиций и соединение по партициям
+namespace {
+    vector<string> sortedLines(const string& output) {
+        vector<string> lines;
+        istringstream in(output);
+        string line;
+        while (getline(in, line)) {
+            if (line.rfind("Таблица1", 0) == 0) {
+                lines.push_back(line);
+            }
+        }
+        sort(lines.begin(), lines.end());
+        return lines;
+    }
+}
+
+int main() {
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 20, "structure": {
+        "A": {"columns": ["k", "v"], "partition_by": "k", "partitions": 4},
+        "B": {"columns": ["k", "w"], "partition_by": "k", "partitions": 4},
+        "K": {"columns": ["v"], "partition_by": "K_pk", "partitions": 4},
+        "PA": ["k", "v"],
+        "PB": ["k", "w"]}})");
+    const Node* a = FindTable(json_table.Tablehead, "A");
+    for (int i = 0; i < 200; i++) {
+        string key = "key" + to_string(i % 50);
+        for (const char* table : {"A", "PA"}) {
+            insert(string("INSERT INTO ") + table + " VALUES ('" + key + "', 'v" + to_string(i) + "')", json_table);
+        }
+        if (i % 3 == 0) {
+            for (const char* table : {"B", "PB"}) {
+                insert(string("INSERT INTO ") + table + " VALUES ('" + key + "', 'w" + to_string(i) + "')", json_table);
+            }
+        }
+    }
+
+    // Каждая строка лежит в партиции своего ключа
+    size_t total = 0;
+    for (int p = 0; p < a->partitions; p++) {
+        for (int chunk : partitionChunks(a, p)) {
+            CHECK(chunk / kPartitionChunks == p);
+            rapidcsv::Document doc = readChunk(a, chunk);
+            for (size_t r = 0; r < doc.GetRowCount(); r++) {
+                CHECK(partitionOf(a, doc.GetCell<string>(1, r)) == p);
+            }
+            total += doc.GetRowCount();
+        }
+    }
+    CHECK(total == 200);
+    CHECK(tableChunks(a).size() > size_t(a->partitions));
+
+    // Соединение по ключам разбиения идёт по партициям и совпадает с соединением без разбиения
+    string partitioned = captureOutput([&] { explainAnalyze("EXPLAIN ANALYZE SELECT A.v B.w FROM A B WHERE A.k = B.k", json_table); });
+    string plain = captureOutput([&] { select("SELECT PA.v PB.w FROM PA PB WHERE PA.k = PB.k", json_table); });
+    CHECK(partitioned.find("PartitionWise(4)") != string::npos);
+    CHECK(!sortedLines(partitioned).empty());
+    CHECK(sortedLines(partitioned) == sortedLines(plain));
+
+    // Равенство по ключу читает одну партицию
+    string point = captureOutput([&] { explainAnalyze("EXPLAIN ANALYZE SELECT A.v B.w FROM A B WHERE A.k = B.k AND A.k = 'key3'", json_table); });
+    CHECK(point.find("partitions=1/4") != string::npos);
+    CHECK(sortedLines(point).size() == 4 * 2); // 4 строки A с key3 на 2 строки B
+
+    // DELETE по ключу разбиения
+    delet("DELETE FROM A WHERE A.k IN ('key3', 'key4')", json_table);
+    CHECK(sortedLines(captureOutput([&] { select("SELECT A.v B.w FROM A B WHERE A.k = B.k AND A.k = 'key3'", json_table); })).empty());
+
+    // Разбиение по первичному ключу: ключ назначается до выбора партиции
+    const Node* k = FindTable(json_table.Tablehead, "K");
+    for (int i = 0; i < 8; i++) {
+        insert("INSERT INTO K VALUES ('k" + to_string(i) + "')", json_table);
+    }
+    int used = 0;
+    for (int p = 0; p < k->partitions; p++) {
+        for (int chunk : partitionChunks(k, p)) {
+            rapidcsv::Document doc = readChunk(k, chunk);
+            used += doc.GetRowCount() > 0;
+            for (size_t r = 0; r < doc.GetRowCount(); r++) {
+                CHECK(partitionOf(k, doc.GetCell<string>(0, r)) == p);
+            }
+        }
+    }
+    CHECK(used > 1);
+    string byPk = captureOutput([&] { explainAnalyze("EXPLAIN ANALYZE SELECT K.v B.w FROM K B WHERE K.K_pk = '3'", json_table); });
+    CHECK(byPk.find("partitions=1/4") != string::npos);
+    CHECK(byPk.find("Таблица1 (v): k2") != string::npos);
+    delet("DELETE FROM K WHERE K.K_pk = '3'", json_table);
+    size_t left = 0;
+    for (int chunk : tableChunks(k)) {
+        left += readChunk(k, chunk).GetRowCount();
+    }
+    CHECK(left == 7);
+    return checkResult("partition");
+}
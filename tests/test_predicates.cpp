@@ -0,0 +1,86 @@
+#include "check.h"
+#include "../select.h"
+#include "../predicate.h"
+#include "../ordered_index.h"
+
+// Условия =, <, >, BETWEEN, LIKE, IN и чтение по упорядоченному индексу
+namespace {
+    Predicate parse(const string& text) {
+        istringstream iss(text);
+        string op;
+        iss >> op;
+        Predicate pred;
+        CHECK(parsePredicate(op, iss, pred));
+        return pred;
+    }
+
+    size_t countRows(const string& output) {
+        size_t rows = 0;
+        for (size_t pos = output.find("Таблица1"); pos != string::npos; pos = output.find("Таблица1", pos + 1)) {
+            rows++;
+        }
+        return rows;
+    }
+}
+
+int main() {
+    Predicate between = parse("BETWEEN 'b' AND 'd'");
+    CHECK(between.matches("b") && between.matches("c") && between.matches("d") && !between.matches("e"));
+    CHECK(between.mayOverlap("a", "b") && !between.mayOverlap("e", "f"));
+
+    Predicate prefix = parse("LIKE 'ab%'");
+    CHECK(prefix.op == CompareOp::Prefix && prefix.matches("abc") && !prefix.matches("ac"));
+    CHECK(prefix.mayOverlap("aa", "ab") && !prefix.mayOverlap("ac", "az"));
+    CHECK(parse("LIKE 'ab'").op == CompareOp::Eq);
+
+    Predicate in = parse("IN ('c', 'a', 'c')");
+    CHECK(in.values == vector<string>({"a", "c"}));
+    CHECK(in.matches("a") && !in.matches("b") && in.exactValues());
+    CHECK(parse("< 'm'").matches("a") && parse("> 'm'").matches("z"));
+
+    Predicate bad;
+    istringstream noQuotes("x");
+    CHECK(!parsePredicate("=", noQuotes, bad));
+    istringstream middlePercent("'a%b'");
+    CHECK(!parsePredicate("LIKE", middlePercent, bad));
+
+    map<string, int> items{{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+    int sum = 0;
+    forEachMatch(items, between, [&](const auto& item) { sum += item.second; });
+    CHECK(sum == 2 + 3 + 4);
+
+    // Индекс по колонке a: диапазон выбирает только файлы с подходящими строками
+    TableJson json_table = loadSchema(R"({"name": "db", "tuples_limit": 50, "structure": {
+        "A": {"columns": ["a", "b"], "indexes": ["a"]},
+        "B": ["c"]}})");
+    const Node* table = FindTable(json_table.Tablehead, "A");
+    for (int i = 0; i < 300; i++) {
+        insert("INSERT INTO A VALUES ('k" + to_string(1000 + i) + "', 'x')", json_table);
+    }
+    insert("INSERT INTO B VALUES ('y')", json_table);
+
+    Predicate range = parse("BETWEEN 'k1010' AND 'k1019'");
+    size_t matches = 0;
+    set<int> chunks = indexLookup(table, 1, range, &matches);
+    CHECK(matches == 10 && chunks == set<int>({1}));
+    CHECK(indexCount(table, 1, parse("LIKE 'k12%'")) == 100);
+
+    string output = captureOutput([&] {
+        explainAnalyze("EXPLAIN ANALYZE SELECT A.a B.c FROM A B WHERE A.a BETWEEN 'k1010' AND 'k1019'", json_table);
+    });
+    CHECK(countRows(output) == 10);
+    CHECK(output.find("IndexScan A") != string::npos);
+    CHECK(output.find("chunks=1 ") != string::npos);
+    string metrics = captureOutput([] { dumpMetrics(cout); });
+    CHECK(metrics.find("\"IndexScan A\"") != string::npos); // ключ метрик - вид оператора и таблица
+    CHECK(metrics.find("est=") == string::npos && metrics.find("k1010") == string::npos);
+
+    CHECK(countRows(captureOutput([&] { select("SELECT A.a B.c FROM A B WHERE A.a IN ('k1000', 'k1299', 'zz')", json_table); })) == 2);
+    CHECK(countRows(captureOutput([&] { select("SELECT A.a B.c FROM A B WHERE A.a > 'k1295' AND A.a < 'k1298'", json_table); })) == 2);
+
+    // DELETE по префиксу убирает строки и из индекса
+    delet("DELETE FROM A WHERE A.a LIKE 'k101%'", json_table);
+    CHECK(indexCount(table, 1, range) == 0);
+    CHECK(countRows(captureOutput([&] { select("SELECT A.a B.c FROM A B WHERE A.a LIKE 'k10%'", json_table); })) == 90);
+    return checkResult("predicates");
+}